@@ -0,0 +1,202 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "AudioRedundancy.h"
+
+#include <algorithm>
+
+#include "packet_view.h"
+
+static constexpr uint32_t STREAM_MASK = AUDIO_REDUNDANCY_MAX_STREAMS - 1;
+
+static_assert((AUDIO_REDUNDANCY_MAX_STREAMS & STREAM_MASK) == 0, "AUDIO_REDUNDANCY_MAX_STREAMS must be a power of two");
+
+AudioRedundancy::AudioRedundancy(uint16_t self_uid) {
+    m_self_uid = self_uid;
+    m_links = {nullptr, nullptr};
+    m_next_link = AUDIO_LINK_PRIMARY;
+    m_active_link = AUDIO_LINK_PRIMARY;
+
+    for (auto& counter : m_received) {
+        counter = 0;
+    }
+    for (auto& counter : m_used) {
+        counter = 0;
+    }
+    m_duplicates = 0;
+    m_late = 0;
+    m_unstamped = 0;
+    m_untracked = 0;
+
+    reset();
+}
+
+void AudioRedundancy::set_links(LowLatSocket *primary, LowLatSocket *secondary) {
+    m_links = {primary, secondary};
+}
+
+bool AudioRedundancy::enabled() const {
+    return m_links[AUDIO_LINK_PRIMARY] != nullptr && m_links[AUDIO_LINK_SECONDARY] != nullptr;
+}
+
+int AudioRedundancy::receive(uint8_t *buffer, size_t size, bool async) {
+    if (!enabled()) {
+        return 0;
+    }
+
+    int recv_bytes = 0;
+    uint8_t link = m_next_link;
+
+    // Links polled in turn so that a busy link does not delay the other one
+    for (size_t attempt = 0; attempt < 2 && recv_bytes <= 0; attempt++) {
+        link = m_next_link;
+        m_next_link ^= 1;
+        recv_bytes = m_links[link]->receive_data_raw(reinterpret_cast<char*>(buffer), size, true);
+    }
+
+    if (recv_bytes <= 0) {
+        if (async) {
+            return 0;
+        }
+
+        // Nothing pending, wait on the link that delivered last. If it went down the wait times out and the
+        // other link is waited on next time
+        link = m_active_link;
+        recv_bytes = m_links[link]->receive_data_raw(reinterpret_cast<char*>(buffer), size, false);
+        if (recv_bytes <= 0) {
+            m_active_link ^= 1;
+            return 0;
+        }
+    }
+
+    m_active_link = link;
+
+    // Traffic for other nodes must not take stream entries, broadcast traffic alone would fill the table
+    PacketView<AudioData> view{buffer, (size_t)recv_bytes};
+    if (!view.valid() || view.llhdr().dest_uid != m_self_uid) {
+        return 0;
+    }
+
+    bump(m_received[link]);
+
+    const AudioPacket& packet = view.packet();
+    if (!accept(view.llhdr().sender_uid, packet.packet_data.channel, packet.header.timestamp, (AudioLink)link)) {
+        return 0;
+    }
+
+    return recv_bytes;
+}
+
+bool AudioRedundancy::accept(uint16_t sender_uid, uint8_t channel, uint64_t timestamp, AudioLink link) {
+    // Unmatchable frames, only one copy is taken
+    if (timestamp == 0) {
+        if (link != AUDIO_LINK_PRIMARY) {
+            bump(m_duplicates);
+            return false;
+        }
+
+        bump(m_unstamped);
+        bump(m_used[link]);
+        return true;
+    }
+
+    Stream* stream = find_stream(((uint32_t)sender_uid << 8 | channel) + 1, timestamp);
+    if (stream == nullptr) {
+        // Table full, frames are delivered without deduplication rather than lost
+        bump(m_untracked);
+        bump(m_used[link]);
+        return true;
+    }
+
+    size_t filled = std::min<size_t>(stream->count, AUDIO_REDUNDANCY_WINDOW);
+    size_t oldest = 0;
+
+    for (size_t i = 0; i < filled; i++) {
+        if (stream->timestamps[i] == timestamp) {
+            bump(m_duplicates);
+            return false;
+        }
+
+        if (stream->timestamps[i] < stream->timestamps[oldest]) {
+            oldest = i;
+        }
+    }
+
+    if (filled < AUDIO_REDUNDANCY_WINDOW) {
+        stream->timestamps[filled] = timestamp;
+    } else if (timestamp < stream->timestamps[oldest]) {
+        // Its copy may already have left the window, delivering it could play a period twice
+        bump(m_late);
+        return false;
+    } else {
+        stream->timestamps[oldest] = timestamp;
+    }
+
+    stream->count++;
+    stream->newest = std::max(stream->newest, timestamp);
+    bump(m_used[link]);
+
+    return true;
+}
+
+AudioRedundancyStats AudioRedundancy::stats() const {
+    AudioRedundancyStats stats{};
+
+    for (size_t link = 0; link < 2; link++) {
+        stats.received[link] = m_received[link].load(std::memory_order_relaxed);
+        stats.used[link] = m_used[link].load(std::memory_order_relaxed);
+    }
+    stats.duplicates = m_duplicates.load(std::memory_order_relaxed);
+    stats.late = m_late.load(std::memory_order_relaxed);
+    stats.unstamped = m_unstamped.load(std::memory_order_relaxed);
+    stats.untracked = m_untracked.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+void AudioRedundancy::reset() {
+    for (auto& stream : m_streams) {
+        stream.key = 0;
+        stream.count = 0;
+        stream.newest = 0;
+    }
+}
+
+AudioRedundancy::Stream *AudioRedundancy::find_stream(uint32_t key, uint64_t timestamp) {
+    // Fibonacci hashing, then linear probing. Entries are never emptied, which would break the probe chains going
+    // through them: idle streams are replaced in place by a new stream instead
+    uint32_t index = (key * 2654435769u) >> 22 & STREAM_MASK;
+    Stream* idle = nullptr;
+
+    for (size_t probe = 0; probe < AUDIO_REDUNDANCY_MAX_STREAMS; probe++) {
+        Stream& stream = m_streams[(index + probe) & STREAM_MASK];
+
+        if (stream.key == key) {
+            return &stream;
+        }
+
+        if (stream.key == 0) {
+            idle = idle == nullptr ? &stream : idle;
+            break;
+        }
+
+        if (idle == nullptr && timestamp > stream.newest + AUDIO_REDUNDANCY_IDLE_US) {
+            idle = &stream;
+        }
+    }
+
+    if (idle != nullptr) {
+        idle->key = key;
+        idle->count = 0;
+        idle->newest = 0;
+    }
+
+    return idle;
+}
+
+void AudioRedundancy::bump(std::atomic<uint64_t> &counter) {
+    // Single writer, no need for an atomic read-modify-write on the audio path
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
@@ -0,0 +1,133 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef AUDIOREDUNDANCY_H
+#define AUDIOREDUNDANCY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "netutils/LowLatSocket.h"
+
+#define AUDIO_REDUNDANCY_WINDOW 16              /**< Timestamps remembered per stream, bounds the tolerated link skew */
+#define AUDIO_REDUNDANCY_MAX_STREAMS 1024       /**< (sender, channel) streams tracked, power of two */
+#define AUDIO_REDUNDANCY_RX_TIMEOUT_US 250      /**< Blocking receive timeout of each link */
+#define AUDIO_REDUNDANCY_IDLE_US 1000000        /**< Streams without frames for this long (audio time) give their entry away */
+
+enum AudioLink : uint8_t {
+    AUDIO_LINK_PRIMARY = 0,
+    AUDIO_LINK_SECONDARY = 1
+};
+
+/**
+ * @struct AudioRedundancyStats
+ * @brief Merger counters, per link where relevant
+ */
+struct AudioRedundancyStats {
+    uint64_t received[2];   /**< Audio frames received on each link */
+    uint64_t used[2];       /**< Frames delivered from each link, the secondary count is what the primary missed or delayed */
+    uint64_t duplicates;    /**< Frames already delivered from the other link */
+    uint64_t late;          /**< Frames older than the whole window, dropped */
+    uint64_t unstamped;     /**< Frames without timestamp, not protected by the secondary link */
+    uint64_t untracked;     /**< Frames delivered without deduplication, every stream entry in use */
+};
+
+/**
+ * @class AudioRedundancy
+ * @brief Seamless protection of the audio plane over two independent networks, in the spirit of SMPTE 2022-7.
+ * Senders transmit every frame on both links, the receiver merges both streams and delivers each
+ * (sender, channel, timestamp) once, whichever link it came from first. Losing a link loses no sample as long as
+ * the other one carries the frame.
+ *
+ * The audio timestamp is the sequence number: it is unique per stream and period. Senders must stamp their frames
+ * with MediaClock::stamp to be protected: frames without a timestamp cannot be matched, they are only taken from
+ * the primary link and counted as unstamped.
+ *
+ * Only frames addressed to this node are tracked. Streams idle for AUDIO_REDUNDANCY_IDLE_US of audio time give
+ * their entry to new streams, so that senders coming and going do not fill the table.
+ * Not thread safe, each receiving thread (router or shard) owns its instance.
+ */
+class AudioRedundancy {
+public:
+    /**
+     * Constructor
+     * @param self_uid UID of this node, frames addressed to other nodes are dropped
+     */
+    explicit AudioRedundancy(uint16_t self_uid);
+    ~AudioRedundancy() = default;
+
+    /**
+     * Set the two receiving sockets. Both should have a bounded receive timeout, AUDIO_REDUNDANCY_RX_TIMEOUT_US.
+     * @param primary Primary network socket, not owned
+     * @param secondary Secondary network socket, not owned
+     */
+    void set_links(LowLatSocket* primary, LowLatSocket* secondary);
+
+    /**
+     * @return true once both links are set
+     */
+    bool enabled() const;
+
+    /**
+     * Receive the next audio frame addressed to this node and not seen yet. Links are polled in turn, a blocking call
+     * waits on the link that delivered last and switches to the other one when it times out.
+     * @param buffer Frame buffer
+     * @param size Buffer size
+     * @param async If false, waits for a frame (bounded by the link receive timeout)
+     * @return Frame size, 0 if nothing new was received
+     */
+    int receive(uint8_t* buffer, size_t size, bool async);
+
+    /**
+     * Check a received frame against the frames already delivered, and record it
+     * @param sender_uid Sender UID
+     * @param channel Audio channel
+     * @param timestamp Audio timestamp
+     * @param link Link the frame came from
+     * @return true if the frame must be delivered
+     */
+    bool accept(uint16_t sender_uid, uint8_t channel, uint64_t timestamp, AudioLink link);
+
+    /**
+     * @return Merger counters, may be read from another thread
+     */
+    AudioRedundancyStats stats() const;
+
+    /**
+     * Forget every stream, for instance after a media clock step
+     */
+    void reset();
+
+private:
+    struct Stream {
+        uint32_t key;       // (sender_uid << 8 | channel) + 1, 0 for a free entry
+        uint32_t count;
+        uint64_t newest;    // Latest timestamp seen, tells idle streams
+        std::array<uint64_t, AUDIO_REDUNDANCY_WINDOW> timestamps;
+    };
+
+    Stream* find_stream(uint32_t key, uint64_t timestamp);
+    static void bump(std::atomic<uint64_t>& counter);
+
+    uint16_t m_self_uid;
+    std::array<LowLatSocket*, 2> m_links;
+    uint8_t m_next_link;
+    uint8_t m_active_link;
+
+    std::array<Stream, AUDIO_REDUNDANCY_MAX_STREAMS> m_streams;
+
+    std::array<std::atomic<uint64_t>, 2> m_received;
+    std::array<std::atomic<uint64_t>, 2> m_used;
+    std::atomic<uint64_t> m_duplicates;
+    std::atomic<uint64_t> m_late;
+    std::atomic<uint64_t> m_unstamped;
+    std::atomic<uint64_t> m_untracked;
+};
+
+
+
+#endif //AUDIOREDUNDANCY_H
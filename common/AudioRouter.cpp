@@ -8,16 +8,21 @@
 #include <algorithm>
 
 #include "NetworkMapper.h"
+#include "ControlStateCache.h"
 
 AudioRouter::AudioRouter(uint16_t self_uid) {
     m_self_uid = self_uid;
     m_routing_callback = [](AudioPacket&, LowLatHeader&) {};
     m_channel_control_callback = [](ControlPacket&, LowLatHeader&) {};
     m_pipe_create_callback = [](ControlPipeCreatePacket&, LowLatHeader&) {};
+    m_control_response_callback = [](ControlResponsePacket&, LowLatHeader&) {};
+    m_control_query_callback = [](ControlQueryPacket&, LowLatHeader&) {};
+    m_control_state_callback = [](ControlStateChunkPacket&, LowLatHeader&) {};
 }
 
 bool AudioRouter::init_router(const std::string &eth_interface, const std::shared_ptr<NetworkMapper>& nmapper) {
     m_nmapper = nmapper;
+    m_eth_interface = eth_interface;
 
     m_audio_iface = std::make_unique<LowLatSocket>(m_self_uid, nmapper);
     if (!m_audio_iface->init_socket(eth_interface, ETH_PROTO_OANAUDIO)) {
@@ -32,6 +37,100 @@ bool AudioRouter::init_router(const std::string &eth_interface, const std::share
     return true;
 }
 
+bool AudioRouter::init_redundancy(const std::string &eth_interface, const std::shared_ptr<NetworkMapper> &nmapper) {
+    m_secondary_audio_iface = std::make_unique<LowLatSocket>(m_self_uid, nmapper);
+    if (!m_secondary_audio_iface->init_socket(eth_interface, ETH_PROTO_OANAUDIO)) {
+        m_secondary_audio_iface.reset();
+        return false;
+    }
+
+    m_secondary_nmapper = nmapper;
+    m_secondary_eth_interface = eth_interface;
+
+    // Blocking receives must time out, a dead link would otherwise hold the other one
+    m_audio_iface->set_receive_timeout(AUDIO_REDUNDANCY_RX_TIMEOUT_US);
+    m_secondary_audio_iface->set_receive_timeout(AUDIO_REDUNDANCY_RX_TIMEOUT_US);
+
+    m_redundancy = std::make_unique<AudioRedundancy>(m_self_uid);
+    m_redundancy->set_links(m_audio_iface.get(), m_secondary_audio_iface.get());
+
+    return true;
+}
+
+AudioRedundancyStats AudioRouter::get_redundancy_stats() const {
+    if (m_shards.empty()) {
+        return m_redundancy ? m_redundancy->stats() : AudioRedundancyStats{};
+    }
+
+    AudioRedundancyStats total{};
+    for (auto& shard : m_shards) {
+        AudioRedundancyStats stats = shard->get_redundancy_stats();
+
+        for (size_t link = 0; link < 2; link++) {
+            total.received[link] += stats.received[link];
+            total.used[link] += stats.used[link];
+        }
+        total.duplicates += stats.duplicates;
+        total.late += stats.late;
+        total.unstamped += stats.unstamped;
+        total.untracked += stats.untracked;
+    }
+
+    return total;
+}
+
+bool AudioRouter::init_shards(uint8_t shard_count, [[maybe_unused]] const std::vector<int> &cpus, [[maybe_unused]] uint8_t rt_prio) {
+    stop_shards();
+
+    if (shard_count == 0) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < shard_count; i++) {
+        auto shard = std::make_unique<AudioShard>(m_self_uid, i, shard_count);
+        if (!shard->init_shard(m_eth_interface, m_nmapper)) {
+            m_shards.clear();
+            return false;
+        }
+
+        if (m_secondary_audio_iface && !shard->init_secondary(m_secondary_eth_interface, m_secondary_nmapper)) {
+            m_shards.clear();
+            return false;
+        }
+
+        shard->set_routing_callback(m_routing_callback);
+        shard->set_mix_bus(m_mix_bus);
+        m_shards.emplace_back(std::move(shard));
+    }
+
+    // Shards receive on their own filtered sockets, the router sockets only send from now on
+    m_audio_iface->set_receive_enabled(false);
+    if (m_secondary_audio_iface) {
+        m_secondary_audio_iface->set_receive_enabled(false);
+    }
+
+#ifndef NO_THREADS
+    for (size_t i = 0; i < m_shards.size(); i++) {
+        int cpu = i < cpus.size() ? cpus[i] : -1;
+        m_shards[i]->launch_shard(cpu, rt_prio);
+    }
+#endif // NO_THREADS
+
+    return true;
+}
+
+void AudioRouter::stop_shards() {
+    // Shards are joined by their destructor
+    m_shards.clear();
+
+    if (m_audio_iface) {
+        m_audio_iface->set_receive_enabled(true);
+    }
+    if (m_secondary_audio_iface) {
+        m_secondary_audio_iface->set_receive_enabled(true);
+    }
+}
+
 void AudioRouter::poll_local_audio_buffer() {
     AudioPacket local_packet;
 
@@ -40,90 +139,179 @@ void AudioRouter::poll_local_audio_buffer() {
         llhdr.sender_uid = m_self_uid;
         llhdr.dest_uid = m_self_uid;
 
-        m_routing_callback(local_packet, llhdr);
+        route_packet(local_packet, llhdr);
     }
 }
 
-
-void AudioRouter::poll_audio_data(bool async) {
-    LowLatPacket<AudioPacket> rx_packet{};
-    if (m_audio_iface->receive_data<LowLatPacket<AudioPacket>>(&rx_packet, async) <= 0) {
-        return;
-    }
-
-    if (rx_packet.llhdr.dest_uid == m_self_uid && rx_packet.payload.header.type == PacketType::AUDIO) {
-        AudioPacket pck = rx_packet.payload;
-        m_routing_callback(pck, rx_packet.llhdr);
+void AudioRouter::route_packet(AudioPacket &packet, LowLatHeader &llhdr) {
+    if (m_mix_bus.handles(packet.packet_data.channel)) {
+        m_mix_bus.accumulate(packet);
+    } else {
+        m_routing_callback(packet, llhdr);
     }
 }
 
-void AudioRouter::poll_control_packets(bool async) {
-    char raw_packet_buffer[256] = {0};
-    auto* header = reinterpret_cast<LowLatPacket<CommonHeader>*>(raw_packet_buffer);
-
-    int recv_bytes = m_control_iface->receive_data_raw(raw_packet_buffer, 128, async);
 
-    if (recv_bytes <= 0) {
-        return;
-    } else {
-        if (header->llhdr.dest_uid != m_self_uid) {
-            return;
+void AudioRouter::poll_audio_data(bool async) {
+#ifdef NO_THREADS
+    if (!m_shards.empty()) {
+        for (auto& shard : m_shards) {
+            shard->shard_update(true);
         }
 
-        // If we don't know the sender yet, keep it in memory to avoid
-        // responses to incoming packet to be dropped
-        if (!m_nmapper->get_mac_by_uid(header->llhdr.sender_uid).has_value()) {
-            PeerInfos pinfos{};
-            pinfos.peer_data.self_uid = header->llhdr.sender_uid;
-            memcpy(&pinfos.peer_data.self_address, header->eth_header.h_source, 6);
+        return;
+    }
+#endif // NO_THREADS
 
-            m_nmapper->add_temp_peer(header->llhdr.sender_uid, pinfos);
-        }
+    alignas(std::max_align_t) uint8_t raw_packet_buffer[sizeof(LowLatPacket<AudioPacket>)];
 
-        // Packet switching
-        if (header->payload.type == PacketType::CONTROL_CREATE) {
-            ControlPipeCreatePacket packet_content{};
+    int recv_bytes;
+    if (m_redundancy) {
+        recv_bytes = m_redundancy->receive(raw_packet_buffer, sizeof(raw_packet_buffer), async);
+    } else {
+        recv_bytes = m_audio_iface->receive_data_raw(reinterpret_cast<char*>(raw_packet_buffer), sizeof(raw_packet_buffer), async);
+    }
 
-            // Extracting packet
-            packet_content.header = header->payload;
-            memcpy(&packet_content.packet_data, raw_packet_buffer + sizeof(LowLatPacket<CommonHeader>), sizeof(ControlPipeCreate));
+    if (recv_bytes <= 0) {
+        return;
+    }
 
-            m_pipe_create_callback(packet_content, header->llhdr);
-        } else if (header->payload.type == PacketType::CONTROL) {
-            ControlPacket packet_content{};
+    PacketView<AudioData> view{raw_packet_buffer, (size_t)recv_bytes};
+    if (view.valid() && view.llhdr().dest_uid == m_self_uid) {
+        route_packet(view.packet(), view.llhdr());
+    }
+}
 
-            // Extracting packet
-            packet_content.header = header->payload;
-            memcpy(&packet_content.packet_data, raw_packet_buffer + sizeof(LowLatPacket<CommonHeader>), sizeof(ControlData));
+void AudioRouter::poll_control_packets(bool async) {
+    // Sized for the largest control packets, batches and state snapshots
+    alignas(std::max_align_t) uint8_t raw_packet_buffer[std::max(sizeof(LowLatPacket<ControlBatchPacket>), sizeof(LowLatPacket<ControlStateChunkPacket>))];
 
-            m_channel_control_callback(packet_content, header->llhdr);
-        } else if (header->payload.type == PacketType::CONTROL_RESPONSE) {
-            ControlResponsePacket packet_content{};
+    int recv_bytes = m_control_iface->receive_data_raw(reinterpret_cast<char*>(raw_packet_buffer), sizeof(raw_packet_buffer), async);
+    if (recv_bytes <= 0) {
+        return;
+    }
 
-            packet_content.header = header->payload;
-            memcpy(&packet_content.packet_data, raw_packet_buffer + sizeof(LowLatPacket<CommonHeader>), sizeof(ControlResponse));
+    FrameView frame{raw_packet_buffer, (size_t)recv_bytes};
+    if (!frame.valid() || frame.llhdr().dest_uid != m_self_uid) {
+        return;
+    }
 
-            m_control_response_callback(packet_content, header->llhdr);
-        } else if (header->payload.type == PacketType::CONTROL_QUERY) {
-            ControlQueryPacket packet_content{};
+    // If we don't know the sender yet, keep it in memory to avoid
+    // responses to incoming packet to be dropped
+    if (!m_nmapper->get_mac_by_uid(frame.llhdr().sender_uid).has_value()) {
+        PeerInfos pinfos{};
+        pinfos.peer_data.self_uid = frame.llhdr().sender_uid;
+        memcpy(&pinfos.peer_data.self_address, frame.eth_header().h_source, 6);
 
-            // Extracting packet
-            packet_content.header = header->payload;
-            memcpy(&packet_content.packet_data, raw_packet_buffer + sizeof(LowLatPacket<CommonHeader>), sizeof(ControlQuery));
+        m_nmapper->add_temp_peer(frame.llhdr().sender_uid, pinfos);
+    } else {
+        m_nmapper->mark_peer_used(frame.llhdr().sender_uid);
+    }
 
-            m_control_query_callback(packet_content, header->llhdr);
+    // Packet switching, handlers get the packet in place in the receive buffer
+    switch (frame.header().type) {
+        case PacketType::CONTROL_CREATE:
+            dispatch_packet(frame.as<ControlPipeCreate>(), m_pipe_create_callback);
+            break;
+        case PacketType::CONTROL: {
+            auto view = frame.as<ControlData>();
+            if (view.valid() && m_control_state) {
+                m_control_state->apply(view.packet().packet_data);
+            }
+
+            dispatch_packet(view, m_channel_control_callback);
+            break;
+        }
+        case PacketType::CONTROL_BATCH: {
+            auto view = frame.as<ControlBatch>();
+            if (!view.valid()) {
+                break;
+            }
+
+            ControlBatchPacket& batch = view.packet();
+            batch.packet_data.count = std::min<uint8_t>(batch.packet_data.count, CONTROL_BATCH_MAX_ENTRIES);
+
+            if (m_control_state) {
+                m_control_state->apply(batch.packet_data);
+            }
+
+            if (m_control_batch_callback) {
+                m_control_batch_callback(batch, view.llhdr());
+            } else {
+                // No batch handler installed, apply entries one by one
+                for (uint8_t i = 0; i < batch.packet_data.count; i++) {
+                    ControlPacket entry{};
+                    entry.header = batch.header;
+                    entry.header.type = PacketType::CONTROL;
+                    entry.packet_data = batch.packet_data.entries[i];
+
+                    m_channel_control_callback(entry, view.llhdr());
+                }
+            }
+            break;
+        }
+        case PacketType::CONTROL_RESPONSE:
+            dispatch_packet(frame.as<ControlResponse>(), m_control_response_callback);
+            break;
+        case PacketType::CONTROL_QUERY: {
+            auto view = frame.as<ControlQuery>();
+            if (view.valid() && m_control_state && view.packet().packet_data.qtype == ControlQueryType::CONTROL_STATE_SYNC) {
+                m_control_state->send_snapshot(*this, view.llhdr().sender_uid, view.packet().packet_data.flags);
+                break;
+            }
+
+            dispatch_packet(view, m_control_query_callback);
+            break;
         }
+        case PacketType::CONTROL_STATE:
+            dispatch_packet(frame.as<ControlStateChunk>(), m_control_state_callback);
+            break;
+        default:
+            break;
     }
 }
 
 void AudioRouter::send_audio_packet(const AudioPacket &packet, uint16_t dest_uid) {
+    if (!m_shards.empty()) {
+        m_shards[packet.packet_data.channel % m_shards.size()]->send_audio_packet(packet, dest_uid);
+        return;
+    }
+
     if (dest_uid != m_self_uid) {
         m_audio_iface->send_data(packet, dest_uid);
+
+        if (m_secondary_audio_iface) {
+            m_secondary_audio_iface->send_data(packet, dest_uid);
+        }
     } else {
         m_local_audio_fifo.enqueue(packet);
     }
 }
 
+void AudioRouter::add_mix_bus_source(uint8_t channel, uint8_t source_channel) {
+    m_mix_bus.add_source(channel, source_channel);
+
+    // Shards own a copy of the bus, only their worker may change it
+    for (auto& shard : m_shards) {
+        shard->add_mix_bus_source(channel, source_channel);
+    }
+}
+
+void AudioRouter::set_mix_bus_callback(const std::function<void(MixBusBlock &)> &callback) {
+    m_mix_bus.set_block_callback(callback);
+}
+
+void AudioRouter::flush_mix_bus() {
+    if (m_shards.empty()) {
+        m_mix_bus.flush();
+        return;
+    }
+
+    for (auto& shard : m_shards) {
+        shard->flush_mix_bus();
+    }
+}
+
 void AudioRouter::set_routing_callback(const std::function<void(AudioPacket&, LowLatHeader&)> &callback) {
     m_routing_callback = callback;
 }
@@ -132,6 +320,10 @@ void AudioRouter::set_control_callback(const std::function<void(ControlPacket&,
     m_channel_control_callback = callback;
 }
 
+void AudioRouter::set_control_batch_callback(const std::function<void(ControlBatchPacket&, LowLatHeader&)>& callback) {
+    m_control_batch_callback = callback;
+}
+
 void AudioRouter::set_pipe_create_callback(const std::function<void(ControlPipeCreatePacket&, LowLatHeader&)>& callback) {
     m_pipe_create_callback = callback;
 }
@@ -144,3 +336,11 @@ void AudioRouter::set_control_query_callback(const std::function<void(ControlQue
     m_control_query_callback = callback;
 }
 
+void AudioRouter::set_control_state_callback(const std::function<void(ControlStateChunkPacket &, LowLatHeader &)> &callback) {
+    m_control_state_callback = callback;
+}
+
+void AudioRouter::set_control_state_cache(const std::shared_ptr<ControlStateCache> &cache) {
+    m_control_state = cache;
+}
+
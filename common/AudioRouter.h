@@ -9,8 +9,15 @@
 #include "third_party/concurrentqueue.h"
 #include "netutils/LowLatSocket.h"
 #include "packet_structs.h"
+#include "packet_view.h"
+#include "AudioShard.h"
+#include "MixBus.h"
+#include "AudioRedundancy.h"
 
 #include <functional>
+#include <vector>
+
+class ControlStateCache;
 
 class AudioRouter {
 public:
@@ -19,6 +26,41 @@ public:
 
     bool init_router(const std::string& eth_interface, const std::shared_ptr<NetworkMapper>& nmapper);
 
+    /**
+     * Enable seamless audio redundancy over a second network: every audio frame is sent on both networks and the
+     * two received streams are merged, frame by frame. Losing either network loses no sample.
+     * The secondary network runs its own mapper, started by the caller on the same UID, which resolves the peers
+     * secondary MAC addresses. Control traffic stays on the primary network.
+     * Must be called after init_router and before init_shards.
+     * @param eth_interface Secondary network interface name
+     * @param nmapper Network mapper of the secondary network
+     * @return true if initialization succeeds
+     */
+    bool init_redundancy(const std::string& eth_interface, const std::shared_ptr<NetworkMapper>& nmapper);
+
+    /**
+     * @return Redundancy merger counters, summed over the shards. All zeros when redundancy is disabled
+     */
+    AudioRedundancyStats get_redundancy_stats() const;
+
+    /**
+     * Switch the audio plane to sharded mode: channels are partitioned across shard_count workers
+     * (channel % shard_count), each with its own socket, FIFO and routing callback copy.
+     * Must be called after init_router and set_routing_callback. poll_audio_data and poll_local_audio_buffer
+     * are not used in this mode, except in NO_THREADS builds where poll_audio_data steps every shard. The router audio
+     * sockets stop receiving until stop_shards.
+     * @param shard_count Number of audio shards
+     * @param cpus CPU to pin each shard on. Missing entries leave the shard unpinned
+     * @param rt_prio SCHED_FIFO priority of the shard workers, 0 to keep the default scheduler
+     * @return true if all the shards were initialized
+     */
+    bool init_shards(uint8_t shard_count, const std::vector<int>& cpus, uint8_t rt_prio);
+
+    /**
+     * Stops all audio shards and goes back to single threaded mode
+     */
+    void stop_shards();
+
     void poll_audio_data(bool async);
     void poll_local_audio_buffer();
     void poll_control_packets(bool async = true);
@@ -30,25 +72,80 @@ public:
         m_control_iface->send_data(pck, dest_uid);
     }
 
+    /**
+     * Sum a source channel into a destination channel instead of routing its packets one by one.
+     * Packets of summed channels are delivered as MixBusBlock to the mix bus callback.
+     * In sharded mode, the source is added by each shard worker before its next packet.
+     * @param channel Destination channel
+     * @param source_channel Source channel feeding it
+     */
+    void add_mix_bus_source(uint8_t channel, uint8_t source_channel);
+
+    /**
+     * Install the summed block handler. Must be called before init_shards.
+     * @param callback Called once per period and destination channel with the summed samples
+     */
+    void set_mix_bus_callback(const std::function<void(MixBusBlock&)>& callback);
+
+    /**
+     * Emit the partial blocks of sources that did not show up for the current period.
+     * In sharded mode, each shard worker emits its own blocks before its next packet, within the socket receive
+     * timeout.
+     */
+    void flush_mix_bus();
+
     void set_routing_callback(const std::function<void(AudioPacket&, LowLatHeader&)> &callback);
     void set_control_callback(const std::function<void(ControlPacket&, LowLatHeader&)>& callback);
+    /**
+     * Install the handler of batched control packets. The whole batch is handed over in a single call so that
+     * it can be applied atomically. When not set, batch entries are forwarded one by one to the control callback.
+     * @param callback Batch handler
+     */
+    void set_control_batch_callback(const std::function<void(ControlBatchPacket&, LowLatHeader&)>& callback);
     void set_control_response_callback(const std::function<void(ControlResponsePacket&, LowLatHeader&)>& callback);
     void set_pipe_create_callback(const std::function<void(ControlPipeCreatePacket&, LowLatHeader&)>& callback);
     void set_control_query_callback(const std::function<void(ControlQueryPacket&, LowLatHeader&)>& callback);
+    void set_control_state_callback(const std::function<void(ControlStateChunkPacket&, LowLatHeader&)>& callback);
+
+    /**
+     * Keep the current value of every received control in a state cache, and answer the CONTROL_STATE_SYNC queries
+     * of the control surfaces from it. Those queries are not forwarded to the control query callback.
+     * @param cache Control state cache, nullptr to disable
+     */
+    void set_control_state_cache(const std::shared_ptr<ControlStateCache>& cache);
 private:
+    template<class T>
+    static void dispatch_packet(const PacketView<T>& view, const std::function<void(OANPacket<T>&, LowLatHeader&)>& callback) {
+        if (view.valid()) {
+            callback(view.packet(), view.llhdr());
+        }
+    }
+
+    void route_packet(AudioPacket& packet, LowLatHeader& llhdr);
+
     std::unique_ptr<LowLatSocket> m_audio_iface;
     std::unique_ptr<LowLatSocket> m_control_iface;
+    std::unique_ptr<LowLatSocket> m_secondary_audio_iface;
+    std::unique_ptr<AudioRedundancy> m_redundancy;
     uint16_t m_self_uid;
 
     moodycamel::ConcurrentQueue<AudioPacket> m_local_audio_fifo;
+    std::vector<std::unique_ptr<AudioShard>> m_shards;
+    MixBus m_mix_bus;
 
     std::shared_ptr<NetworkMapper> m_nmapper;
+    std::string m_eth_interface;
+    std::shared_ptr<ControlStateCache> m_control_state;
+    std::shared_ptr<NetworkMapper> m_secondary_nmapper;
+    std::string m_secondary_eth_interface;
 protected:
     std::function<void(AudioPacket&, LowLatHeader&)> m_routing_callback;
     std::function<void(ControlPacket&, LowLatHeader&)> m_channel_control_callback;
+    std::function<void(ControlBatchPacket&, LowLatHeader&)> m_control_batch_callback;
     std::function<void(ControlPipeCreatePacket&, LowLatHeader&)> m_pipe_create_callback;
     std::function<void(ControlResponsePacket&, LowLatHeader&)> m_control_response_callback;
     std::function<void(ControlQueryPacket&, LowLatHeader&)> m_control_query_callback;
+    std::function<void(ControlStateChunkPacket&, LowLatHeader&)> m_control_state_callback;
 };
 
 
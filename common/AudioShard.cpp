@@ -0,0 +1,176 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "AudioShard.h"
+
+#include "NetworkMapper.h"
+#include "netutils/rt.h"
+#include "packet_view.h"
+
+AudioShard::AudioShard(uint16_t self_uid, uint8_t shard_index, uint8_t shard_count) {
+    m_self_uid = self_uid;
+    m_shard_index = shard_index;
+    m_shard_count = shard_count;
+    m_routing_callback = [](AudioPacket&, LowLatHeader&) {};
+
+#ifndef NO_THREADS
+    m_running = false;
+#endif // NO_THREADS
+}
+
+AudioShard::~AudioShard() {
+#ifndef NO_THREADS
+    stop_shard();
+#endif // NO_THREADS
+}
+
+bool AudioShard::init_shard(const std::string &eth_interface, const std::shared_ptr<NetworkMapper> &nmapper) {
+    m_audio_iface = std::make_unique<LowLatSocket>(m_self_uid, nmapper);
+    if (!m_audio_iface->init_socket(eth_interface, ETH_PROTO_OANAUDIO)) {
+        return false;
+    }
+
+    // A single shard receives everything, no need to filter
+    if (m_shard_count > 1 && !m_audio_iface->attach_modulo_filter(AUDIO_CHANNEL_FRAME_OFFSET, m_shard_count, m_shard_index)) {
+        return false;
+    }
+
+    // Bounded blocking receive so that the worker notices local packets and stop requests
+    m_audio_iface->set_receive_timeout(250);
+
+    return true;
+}
+
+bool AudioShard::init_secondary(const std::string &eth_interface, const std::shared_ptr<NetworkMapper> &nmapper) {
+    m_secondary_audio_iface = std::make_unique<LowLatSocket>(m_self_uid, nmapper);
+    if (!m_secondary_audio_iface->init_socket(eth_interface, ETH_PROTO_OANAUDIO)) {
+        m_secondary_audio_iface.reset();
+        return false;
+    }
+
+    if (m_shard_count > 1 && !m_secondary_audio_iface->attach_modulo_filter(AUDIO_CHANNEL_FRAME_OFFSET, m_shard_count, m_shard_index)) {
+        m_secondary_audio_iface.reset();
+        return false;
+    }
+
+    m_secondary_audio_iface->set_receive_timeout(AUDIO_REDUNDANCY_RX_TIMEOUT_US);
+
+    m_redundancy = std::make_unique<AudioRedundancy>(m_self_uid);
+    m_redundancy->set_links(m_audio_iface.get(), m_secondary_audio_iface.get());
+
+    return true;
+}
+
+AudioRedundancyStats AudioShard::get_redundancy_stats() const {
+    return m_redundancy ? m_redundancy->stats() : AudioRedundancyStats{};
+}
+
+#ifndef NO_THREADS
+void AudioShard::launch_shard(int cpu, uint8_t rt_prio) {
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_worker = std::thread([this, cpu, rt_prio]() {
+        if (cpu >= 0) {
+            oals::rt::set_running_cpu(cpu);
+        }
+
+        if (rt_prio > 0) {
+            oals::rt::set_thread_realtime(rt_prio);
+        }
+
+        while (m_running.load(std::memory_order_relaxed)) {
+            shard_update(false);
+        }
+    });
+}
+
+void AudioShard::stop_shard() {
+    m_running = false;
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+#endif // NO_THREADS
+
+void AudioShard::shard_update(bool async) {
+    apply_mix_bus_commands();
+
+    alignas(std::max_align_t) uint8_t raw_packet_buffer[sizeof(LowLatPacket<AudioPacket>)];
+
+    int recv_bytes;
+    if (m_redundancy) {
+        recv_bytes = m_redundancy->receive(raw_packet_buffer, sizeof(raw_packet_buffer), async);
+    } else {
+        recv_bytes = m_audio_iface->receive_data_raw(reinterpret_cast<char*>(raw_packet_buffer), sizeof(raw_packet_buffer), async);
+    }
+
+    if (recv_bytes > 0) {
+        PacketView<AudioData> view{raw_packet_buffer, (size_t)recv_bytes};
+        if (view.valid() && view.llhdr().dest_uid == m_self_uid) {
+            route_packet(view.packet(), view.llhdr());
+        }
+    }
+
+    AudioPacket local_packet;
+    while (m_local_audio_fifo.try_dequeue(local_packet)) {
+        LowLatHeader llhdr{};
+        llhdr.sender_uid = m_self_uid;
+        llhdr.dest_uid = m_self_uid;
+
+        route_packet(local_packet, llhdr);
+    }
+}
+
+void AudioShard::send_audio_packet(const AudioPacket &packet, uint16_t dest_uid) {
+    if (dest_uid != m_self_uid) {
+        m_audio_iface->send_data(packet, dest_uid);
+
+        if (m_secondary_audio_iface) {
+            m_secondary_audio_iface->send_data(packet, dest_uid);
+        }
+    } else {
+        m_local_audio_fifo.enqueue(packet);
+    }
+}
+
+void AudioShard::set_routing_callback(const std::function<void(AudioPacket &, LowLatHeader &)> &callback) {
+    m_routing_callback = callback;
+}
+
+void AudioShard::set_mix_bus(const MixBus &mix_bus) {
+    m_mix_bus = mix_bus;
+}
+
+void AudioShard::add_mix_bus_source(uint8_t channel, uint8_t source_channel) {
+    m_mix_bus_commands.enqueue(MixBusCommand{false, channel, source_channel});
+}
+
+void AudioShard::flush_mix_bus() {
+    m_mix_bus_commands.enqueue(MixBusCommand{true, 0, 0});
+}
+
+void AudioShard::apply_mix_bus_commands() {
+    MixBusCommand command;
+
+    while (m_mix_bus_commands.try_dequeue(command)) {
+        if (command.flush) {
+            m_mix_bus.flush();
+        } else {
+            m_mix_bus.add_source(command.channel, command.source_channel);
+        }
+    }
+}
+
+void AudioShard::route_packet(AudioPacket &packet, LowLatHeader &llhdr) {
+    if (m_mix_bus.handles(packet.packet_data.channel)) {
+        m_mix_bus.accumulate(packet);
+    } else {
+        m_routing_callback(packet, llhdr);
+    }
+}
@@ -0,0 +1,152 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef AUDIOSHARD_H
+#define AUDIOSHARD_H
+
+#ifndef NO_THREADS
+#include <thread>
+#include <atomic>
+#endif // NO_THREADS
+
+#include <functional>
+#include <memory>
+#include <cstddef>
+
+#include "third_party/concurrentqueue.h"
+#include "netutils/LowLatSocket.h"
+#include "packet_structs.h"
+#include "MixBus.h"
+#include "AudioRedundancy.h"
+
+class NetworkMapper;
+
+/**
+ * Byte offset of AudioData::channel in a received audio frame. Used by the kernel filter to dispatch channels
+ * to the right shard socket.
+ */
+constexpr uint16_t AUDIO_CHANNEL_FRAME_OFFSET = sizeof(ethhdr) + sizeof(LowLatHeader) + sizeof(CommonHeader) + offsetof(AudioData, channel);
+
+/**
+ * @class AudioShard
+ * @brief Handles a subset of the audio channels (channel % shard_count == shard_index) with its own socket,
+ * local FIFO and routing callback. Shards share no mutable state with each other.
+ */
+class AudioShard {
+public:
+    /**
+     * Constructor
+     * @param self_uid Host UID
+     * @param shard_index Index of this shard
+     * @param shard_count Total shard count
+     */
+    AudioShard(uint16_t self_uid, uint8_t shard_index, uint8_t shard_count);
+    ~AudioShard();
+
+    /**
+     * Opens the shard socket and attaches the channel filter
+     * @param eth_interface Physical network interface name
+     * @param nmapper Local network mapper
+     * @return true if initialization succeeds
+     */
+    bool init_shard(const std::string& eth_interface, const std::shared_ptr<NetworkMapper>& nmapper);
+
+    /**
+     * Opens the shard socket on the secondary network. Frames are then sent on both networks and merged on receive.
+     * Must be called after init_shard and before launch_shard.
+     * @param eth_interface Secondary network interface name
+     * @param nmapper Network mapper of the secondary network
+     * @return true if initialization succeeds
+     */
+    bool init_secondary(const std::string& eth_interface, const std::shared_ptr<NetworkMapper>& nmapper);
+
+    /**
+     * @return Redundancy merger counters, all zeros without a secondary network
+     */
+    AudioRedundancyStats get_redundancy_stats() const;
+
+#ifndef NO_THREADS
+    /**
+     * Launch the shard worker thread
+     * @param cpu CPU to pin the worker on, negative to leave it unpinned
+     * @param rt_prio SCHED_FIFO priority of the worker, 0 to keep the default scheduler
+     */
+    void launch_shard(int cpu, uint8_t rt_prio);
+
+    /**
+     * Stops and joins the shard worker thread
+     */
+    void stop_shard();
+#endif // NO_THREADS
+
+    /**
+     * Receive at most one packet from the network and drain the local FIFO
+     * @param async If false, waits for a packet (bounded by the socket receive timeout)
+     */
+    void shard_update(bool async);
+
+    /**
+     * Sends an audio packet using the shard socket, or the shard local FIFO if sent to self
+     * @param packet Packet to send
+     * @param dest_uid Receiver UID
+     */
+    void send_audio_packet(const AudioPacket& packet, uint16_t dest_uid);
+
+    /**
+     * Install the routing callback. Must be called before launch_shard.
+     * @param callback Called from the shard worker for each audio packet addressed to this node
+     */
+    void set_routing_callback(const std::function<void(AudioPacket&, LowLatHeader&)>& callback);
+
+    /**
+     * Install the shard own copy of the mix bus. Must be called before launch_shard.
+     * @param mix_bus Configured mix bus
+     */
+    void set_mix_bus(const MixBus& mix_bus);
+
+    /**
+     * Declare a mix bus source, applied by the worker before its next packet. Safe while the shard runs.
+     * @param channel Destination channel
+     * @param source_channel Source channel
+     */
+    void add_mix_bus_source(uint8_t channel, uint8_t source_channel);
+
+    /**
+     * Ask the worker to emit its partial mix bus blocks before its next packet. Safe while the shard runs.
+     */
+    void flush_mix_bus();
+
+private:
+    struct MixBusCommand {
+        bool flush;
+        uint8_t channel;
+        uint8_t source_channel;
+    };
+
+    void apply_mix_bus_commands();
+
+    void route_packet(AudioPacket& packet, LowLatHeader& llhdr);
+
+    std::unique_ptr<LowLatSocket> m_audio_iface;
+    std::unique_ptr<LowLatSocket> m_secondary_audio_iface;
+    std::unique_ptr<AudioRedundancy> m_redundancy;
+    moodycamel::ConcurrentQueue<AudioPacket> m_local_audio_fifo;
+    std::function<void(AudioPacket&, LowLatHeader&)> m_routing_callback;
+    MixBus m_mix_bus;
+    moodycamel::ConcurrentQueue<MixBusCommand> m_mix_bus_commands;    // Mix bus changes from other threads
+
+    uint16_t m_self_uid;
+    uint8_t m_shard_index;
+    uint8_t m_shard_count;
+
+#ifndef NO_THREADS
+    std::thread m_worker;
+    std::atomic<bool> m_running;
+#endif // NO_THREADS
+};
+
+
+
+#endif //AUDIOSHARD_H
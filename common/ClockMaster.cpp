@@ -9,8 +9,11 @@
 
 #include "ClockMaster.h"
 
-ClockMaster::ClockMaster(uint16_t self_uid, const std::string& iface, std::shared_ptr<NetworkMapper> nmapper) {
+#include <unordered_set>
+
+ClockMaster::ClockMaster(uint16_t self_uid, const std::string& iface, std::shared_ptr<NetworkMapper> nmapper, uint64_t sync_interval_us) {
     m_nmapper = nmapper;
+    m_self_uid = self_uid;
 
     m_sync_socket = std::make_shared<LowLatSocket>(self_uid, nmapper);
     if (!m_sync_socket->init_socket(iface, EthProtocol::ETH_PROTO_OANSYNC)) {
@@ -19,47 +22,354 @@ ClockMaster::ClockMaster(uint16_t self_uid, const std::string& iface, std::share
 #endif  // __linux__
     }
 
+    // Bounded blocking receive so that the scheduler keeps running without traffic
+    m_sync_socket->set_receive_timeout(1000);
+
+    m_standby_clock = std::make_unique<ClockSlave>(m_sync_socket, nmapper);
+
+    m_sync_interval_us = sync_interval_us;
+    m_next_round = 0;
+    m_started_at = 0;
+    m_active = false;
+    m_broadcast_sync = false;
+    m_sync_seq = 0;
+
     m_sync_states = {};
+    m_wheel = nullptr;
+    m_sync_timer = 0;
+
+#ifndef NO_THREADS
+    m_running = false;
+#endif // NO_THREADS
+}
+
+ClockMaster::~ClockMaster() {
+    stop_sync_process();
 }
 
 void ClockMaster::begin_sync_process() {
-    m_sync_states.clear();
+    m_sync_seq++;
 
+    // Standby masters are synced like slaves so that they keep the network time when taking over
     auto slaves = m_nmapper->get_clock_slaves();
+    for (auto& master : m_nmapper->get_clock_masters()) {
+        if (master.peer_data.self_uid != m_self_uid) {
+            slaves.push_back(master);
+        }
+    }
+
+    prune_sync_states(slaves);
+
+    if (m_broadcast_sync) {
+        start_broadcast_sync(slaves);
+        return;
+    }
+
     for (auto& s : slaves) {
         start_clock_sync(s);
     }
 }
 
-void ClockMaster::sync_process() {
-    LowLatPacket<ClockSyncPacket> ck_packet{};
+void ClockMaster::set_broadcast_sync(bool enabled) {
+    m_broadcast_sync = enabled;
+}
+
+void ClockMaster::sync_process(bool async) {
+    alignas(std::max_align_t) uint8_t raw_packet_buffer[sizeof(LowLatPacket<ClockSyncPacket>)];
+
+    int recv_bytes = m_sync_socket->receive_data_raw(reinterpret_cast<char*>(raw_packet_buffer), sizeof(raw_packet_buffer), async);
+    if (recv_bytes <= 0) {
+        return;
+    }
+
+    PacketView<ClockSync> view{raw_packet_buffer, (size_t)recv_bytes};
+    if (view.valid()) {
+        process_packet(view.packet(), view.llhdr().sender_uid);
+    }
+}
+
+void ClockMaster::sync_update() {
+    uint64_t now = oals::tstamp::now_us();
+    if (m_started_at == 0) {
+        m_started_at = now;
+    }
+
+    update_election(now);
+
+#ifndef NO_THREADS
+    std::unique_lock<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+
+    // Exchanges that did not get their DELAY_REQ within half an interval are lost
+    for (auto& [uid, state] : m_sync_states) {
+        if (state.state == ClockSyncState::CKSYNC_SYNC && now - state.sent_at > m_sync_interval_us / 2) {
+            state.state = ClockSyncState::CKSYNC_NO_SYNC;
+            state.lost++;
+            slave_stats(uid).record_lost();
+        }
+    }
+
+    if (!m_active || now < m_next_round) {
+        return;
+    }
+
+#ifndef NO_THREADS
+    m.unlock();
+#endif // NO_THREADS
+
+    m_next_round = now + m_sync_interval_us;
+
+    send_announce();
+    begin_sync_process();
+}
+
+void ClockMaster::schedule_on(TimerWheel &wheel) {
+    if (m_wheel != nullptr) {
+        m_wheel->cancel(m_sync_timer);
+    }
+
+    m_wheel = &wheel;
+    m_sync_timer = wheel.schedule(0, [this]() {
+        sync_update();
+    }, m_sync_interval_us / 4);
+}
+
+#ifndef NO_THREADS
+void ClockMaster::launch_sync_process() {
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_sync_thread = std::thread([this]() {
+        while (m_running.load(std::memory_order_relaxed)) {
+            sync_update();
+            sync_process(false);
+        }
+    });
+}
+
+void ClockMaster::launch_sync_process(TimerWheel &wheel) {
+    if (m_running) {
+        return;
+    }
+
+    schedule_on(wheel);
+
+    m_running = true;
+    m_sync_thread = std::thread([this]() {
+        while (m_running.load(std::memory_order_relaxed)) {
+            sync_process(false);
+        }
+    });
+}
+#endif // NO_THREADS
+
+void ClockMaster::stop_sync_process() {
+    if (m_wheel != nullptr) {
+        m_wheel->cancel(m_sync_timer);
+        m_wheel = nullptr;
+    }
+
+#ifndef NO_THREADS
+    m_running = false;
+
+    if (m_sync_thread.joinable()) {
+        m_sync_thread.join();
+    }
+#endif // NO_THREADS
+}
+
+bool ClockMaster::is_active_master() const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+    return m_active;
+}
+
+std::unordered_map<uint16_t, SlaveSyncState> ClockMaster::get_sync_states() const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+    return m_sync_states;
+}
+
+std::shared_ptr<const ClockSyncStats> ClockMaster::get_slave_stats(uint16_t slave_uid) const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+    auto stats = m_slave_stats.find(slave_uid);
+    if (stats == m_slave_stats.end()) {
+        return {};
+    }
+
+    return stats->second;
+}
+
+uint64_t ClockMaster::now_network_us() {
+    return m_standby_clock->now_network_us();
+}
+
+void ClockMaster::prune_sync_states(const std::vector<PeerInfos> &slaves) {
+    std::unordered_set<uint16_t> known;
+    for (auto& s : slaves) {
+        known.insert(s.peer_data.self_uid);
+    }
+
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+
+    // Slaves lost by the mapper, the stats objects stay valid for the applications still holding them
+    std::erase_if(m_sync_states, [&known](const std::pair<const uint16_t, SlaveSyncState>& pred) {
+        return !known.contains(pred.first);
+    });
+    std::erase_if(m_slave_stats, [&known](const std::pair<const uint16_t, std::shared_ptr<ClockSyncStats>>& pred) {
+        return !known.contains(pred.first);
+    });
+}
+
+ClockSyncStats &ClockMaster::slave_stats(uint16_t slave_uid) {
+    // Called with m_states_mutex held
+    auto& stats = m_slave_stats[slave_uid];
+    if (!stats) {
+        stats = std::make_shared<ClockSyncStats>();
+    }
+
+    return *stats;
+}
+
+void ClockMaster::update_election(uint64_t now) {
+    // A master is considered gone when it missed one and a half announce
+    uint64_t announce_timeout = m_sync_interval_us + m_sync_interval_us / 2;
+
+    // On startup, listen for an announce period before claiming the network, unless no other master is known
+    bool listened = now - m_started_at > announce_timeout || m_nmapper->get_clock_masters().empty();
+
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
 
-    if (m_sync_socket->receive_data(&ck_packet) > 0) {
-        if (ck_packet.payload.header.type == PacketType::CLOCK_SYNC) {
-            process_packet(ck_packet.payload, ck_packet.llhdr.sender_uid);
+    std::erase_if(m_master_announces, [now, announce_timeout](const std::pair<const uint16_t, uint64_t>& pred) {
+        return now - pred.second > announce_timeout;
+    });
+
+    bool better_master = std::any_of(m_master_announces.begin(), m_master_announces.end(), [this](const std::pair<const uint16_t, uint64_t>& pred) {
+        return pred.first < m_self_uid;
+    });
+
+    bool active = !better_master && listened;
+
+    if (active != m_active) {
+#ifdef __linux__
+        std::cout << (active ? "Clock master active" : "Clock master standing by") << " (ID = " << m_self_uid << ")" << std::endl;
+#endif // __linux__
+        m_active = active;
+        m_next_round = now;
+
+        if (!active) {
+            // Exchanges in flight are answered by the new active master
+            m_sync_states.clear();
         }
     }
 }
 
 void ClockMaster::process_packet(ClockSyncPacket &csp, uint16_t originator) {
+    // Own frames looped back by the socket
+    if (originator == m_self_uid) {
+        return;
+    }
+
     if (csp.packet_data.packet_state == ClockSyncState::CKSYNC_DELAY_REQ) {
         ClockSyncPacket del_resp{};
         del_resp.header.type = PacketType::CLOCK_SYNC;
-        del_resp.header.timestamp = NetworkMapper::local_now_us();
+        del_resp.header.version = OAN_PROTOCOL_VERSION;
+        del_resp.header.timestamp = now_network_us();
         del_resp.packet_data.packet_state = ClockSyncState::CKSYNC_DELAY_RESP;
+        del_resp.packet_data.seq_id = csp.packet_data.seq_id;
 
         m_sync_socket->send_data(del_resp, originator);
+
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+        auto state = m_sync_states.find(originator);
+        if (state != m_sync_states.end() && state->second.state == ClockSyncState::CKSYNC_SYNC) {
+            state->second.state = ClockSyncState::CKSYNC_NO_SYNC;
+            state->second.exchanges++;
+
+            slave_stats(originator).record_exchange(
+                csp.packet_data.report_offset_ns,
+                csp.packet_data.report_delay_ns,
+                csp.packet_data.report_freq_error_ppb,
+                oals::tstamp::now_us()
+            );
+        }
+    } else if (csp.packet_data.packet_state == ClockSyncState::CKSYNC_ANNOUNCE) {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+        m_master_announces[originator] = oals::tstamp::now_us();
+    } else if (!is_active_master()) {
+        // SYNC, FOLLOW_UP and DELAY_RESP of the active master
+        m_standby_clock->process_packet(csp, originator);
     }
 }
 
+void ClockMaster::send_announce() {
+    ClockSyncPacket pck{};
+    pck.header.type = PacketType::CLOCK_SYNC;
+    pck.header.version = OAN_PROTOCOL_VERSION;
+    pck.header.timestamp = now_network_us();
+    pck.packet_data.packet_state = ClockSyncState::CKSYNC_ANNOUNCE;
+
+    m_sync_socket->send_data(pck, 0);
+}
+
 void ClockMaster::start_clock_sync(PeerInfos &slave) {
     ClockSyncPacket pck{};
     pck.header.type = PacketType::CLOCK_SYNC;
-    pck.header.timestamp = NetworkMapper::local_now_us();
+    pck.header.version = OAN_PROTOCOL_VERSION;
+    pck.header.timestamp = now_network_us();
     pck.packet_data.packet_state = ClockSyncState::CKSYNC_SYNC;
+    pck.packet_data.seq_id = m_sync_seq;
 
     m_sync_socket->send_data(pck, slave.peer_data.self_uid);
+    uint64_t sent_at = oals::tstamp::now_us();
 
-    m_sync_states[slave.peer_data.self_uid] = ClockSyncState::CKSYNC_SYNC;
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+    SlaveSyncState& state = m_sync_states[slave.peer_data.self_uid];
+    state.state = ClockSyncState::CKSYNC_SYNC;
+    state.sent_at = sent_at;
 }
 
+void ClockMaster::start_broadcast_sync(const std::vector<PeerInfos> &slaves) {
+    ClockSyncPacket pck{};
+    pck.header.type = PacketType::CLOCK_SYNC;
+    pck.header.version = OAN_PROTOCOL_VERSION;
+    pck.header.timestamp = now_network_us();
+    pck.packet_data.packet_state = ClockSyncState::CKSYNC_SYNC;
+    pck.packet_data.flags = CKSYNC_FLAG_TWO_STEP;
+    pck.packet_data.seq_id = m_sync_seq;
+
+    m_sync_socket->send_data(pck, 0);
+
+    // Stamped once the frame left the socket, every slave gets the same t1
+    ClockSyncPacket follow_up = pck;
+    follow_up.header.timestamp = now_network_us();
+    follow_up.packet_data.packet_state = ClockSyncState::CKSYNC_FOLLOW_UP;
+
+    m_sync_socket->send_data(follow_up, 0);
+    uint64_t sent_at = oals::tstamp::now_us();
+
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_states_mutex};
+#endif // NO_THREADS
+    for (auto& s : slaves) {
+        SlaveSyncState& state = m_sync_states[s.peer_data.self_uid];
+        state.state = ClockSyncState::CKSYNC_SYNC;
+        state.sent_at = sent_at;
+    }
+}
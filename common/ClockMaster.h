@@ -8,26 +8,160 @@
 
 #include "netutils/LowLatSocket.h"
 #include "NetworkMapper.h"
+#include "ClockSlave.h"
 #include "clock.h"
+#include "packet_view.h"
+#include "ClockStats.h"
+#include "TimerWheel.h"
 
+#ifndef NO_THREADS
+#include <thread>
+#include <atomic>
+#include <mutex>
+#endif // NO_THREADS
+
+#include <memory>
 #include <unordered_map>
 
+/**
+ * @struct SlaveSyncState
+ * @brief Progress of the current sync exchange with a slave
+ */
+struct SlaveSyncState {
+    ClockSyncState state;   /**< CKSYNC_SYNC while waiting for the slave DELAY_REQ, CKSYNC_NO_SYNC otherwise */
+    uint64_t sent_at;       /**< Local time the SYNC was sent */
+    uint32_t exchanges;     /**< Completed exchanges */
+    uint32_t lost;          /**< Exchanges that timed out */
+};
+
+/**
+ * @class ClockMaster
+ * @brief Clock sync master. Runs sync exchanges with every clock slave at a fixed rate. When several masters are
+ * configured, only the one with the lowest UID among those announcing themselves is active, the others stand by
+ * and take over when its announces stop.
+ *
+ * The active master also syncs the standby masters, which discipline their own network time to it like slaves do.
+ * Every master stamps its sync packets with that network time, so that a failover keeps the time base of the
+ * previous master, extrapolated from the last exchanges.
+ */
 class ClockMaster {
 public:
-    ClockMaster(uint16_t self_uid, const std::string& iface, std::shared_ptr<NetworkMapper> nmapper);
-    ~ClockMaster() = default;
+    /**
+     * Constructor
+     * @param self_uid Host UID
+     * @param iface Physical network interface name
+     * @param nmapper Local network mapper
+     * @param sync_interval_us Delay between two sync rounds in us
+     */
+    ClockMaster(uint16_t self_uid, const std::string& iface, std::shared_ptr<NetworkMapper> nmapper, uint64_t sync_interval_us = 125000);
+    ~ClockMaster();
 
+    /**
+     * Start a sync exchange with every known slave now
+     */
     void begin_sync_process();
-    void sync_process();
+
+    /**
+     * Receive and process at most one sync packet
+     * @param async If false, waits for a packet (bounded by the socket receive timeout)
+     */
+    void sync_process(bool async = true);
+
+    /**
+     * Scheduler step : master election, announces, periodic sync rounds and exchange timeouts.
+     * May run on another thread than sync_process.
+     */
+    void sync_update();
+
+    /**
+     * Schedule sync_update on a timer wheel, four times per sync interval. NO_THREADS hosts advance the wheel and
+     * call sync_process from their loop.
+     * @param wheel Timer wheel, must outlive the master or stop_sync_process must be called first
+     */
+    void schedule_on(TimerWheel& wheel);
+
+#ifndef NO_THREADS
+    /**
+     * Launch a thread running the scheduler and the packet processing
+     */
+    void launch_sync_process();
+
+    /**
+     * Run the scheduler on a shared timer wheel and launch a thread for the packet processing only
+     * @param wheel Timer wheel, launched by the caller
+     */
+    void launch_sync_process(TimerWheel& wheel);
+#endif // NO_THREADS
+
+    /**
+     * Cancel the scheduler timer and join the sync thread
+     */
+    void stop_sync_process();
+
+    /**
+     * Switch between one unicast SYNC per slave and a single broadcast two-step SYNC / FOLLOW_UP per round.
+     * DELAY_REQ / DELAY_RESP stay unicast in both modes.
+     * @param enabled true to use broadcast SYNC
+     */
+    void set_broadcast_sync(bool enabled);
+
+    /**
+     * @return true if this node is the elected clock master
+     */
+    bool is_active_master() const;
+
+    /**
+     * @return Current exchange state of every slave
+     */
+    std::unordered_map<uint16_t, SlaveSyncState> get_sync_states() const;
+
+    /**
+     * Sync quality metrics of a slave, fed by the reports slaves attach to their DELAY_REQ and by the master own
+     * exchange accounting. The returned object is updated live and can be read from any thread.
+     * @param slave_uid Slave UID
+     * @return Slave metrics, null if the slave was never synchronized by this master
+     */
+    std::shared_ptr<const ClockSyncStats> get_slave_stats(uint16_t slave_uid) const;
+
+    /**
+     * Network time served by this master. Follows the active master while standing by.
+     * @return Network time in us
+     */
+    uint64_t now_network_us();
 
 private:
     void start_clock_sync(PeerInfos& slave);
+    void start_broadcast_sync(const std::vector<PeerInfos>& slaves);
     void process_packet(ClockSyncPacket& csp, uint16_t originator);
+    void send_announce();
+    void update_election(uint64_t now);
+    void prune_sync_states(const std::vector<PeerInfos>& slaves);
+    ClockSyncStats& slave_stats(uint16_t slave_uid);
 
     std::shared_ptr<NetworkMapper> m_nmapper;
     std::shared_ptr<LowLatSocket> m_sync_socket;
+    std::unique_ptr<ClockSlave> m_standby_clock;
+    uint16_t m_self_uid;
+
+    uint64_t m_sync_interval_us;
+    uint64_t m_next_round;
+    uint64_t m_started_at;
+
+    bool m_active;
+    bool m_broadcast_sync;
+    uint16_t m_sync_seq;
+    std::unordered_map<uint16_t, uint64_t> m_master_announces;
+    std::unordered_map<uint16_t, SlaveSyncState> m_sync_states;
+    std::unordered_map<uint16_t, std::shared_ptr<ClockSyncStats>> m_slave_stats;
+
+    TimerWheel* m_wheel;
+    TimerId m_sync_timer;
 
-    std::unordered_map<uint16_t, ClockSyncState> m_sync_states;
+#ifndef NO_THREADS
+    std::thread m_sync_thread;
+    std::atomic<bool> m_running;
+    mutable std::mutex m_states_mutex;
+#endif // NO_THREADS
 };
 
 
@@ -0,0 +1,114 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "ClockServo.h"
+
+#include <algorithm>
+#include <cmath>
+
+ClockServo::ClockServo(double kp, double ki, uint64_t step_threshold_us, uint64_t delay_margin_us) {
+    m_kp = kp;
+    m_ki = ki;
+    m_step_threshold_us = step_threshold_us;
+    m_delay_margin_us = delay_margin_us;
+
+    reset();
+}
+
+void ClockServo::reset() {
+    m_state = ClockServoState::UNLOCKED;
+    m_offset = 0.0;
+    m_drift = 0.0;
+    m_ref_local = 0;
+    m_last_error = 0.0;
+
+    m_delays.fill(0);
+    m_delay_count = 0;
+    m_delay_idx = 0;
+}
+
+bool ClockServo::sample(int64_t offset_us, int64_t delay_us, uint64_t local_us) {
+    // Every measured delay enters the window, so that a lasting path change ends up being accepted
+    m_delays[m_delay_idx] = delay_us;
+    m_delay_idx = (m_delay_idx + 1) % CLOCK_SERVO_WINDOW;
+    m_delay_count = std::min<size_t>(m_delay_count + 1, CLOCK_SERVO_WINDOW);
+
+    int64_t min_delay = get_min_delay();
+    int64_t margin = std::max<int64_t>(m_delay_margin_us, min_delay / 4);
+    if (delay_us > min_delay + margin) {
+        return false;
+    }
+
+    switch (m_state) {
+        case ClockServoState::UNLOCKED:
+            m_offset = offset_us;
+            m_ref_local = local_us;
+            m_state = ClockServoState::FREQ_ESTIMATE;
+            break;
+        case ClockServoState::FREQ_ESTIMATE: {
+            if (local_us <= m_ref_local) {
+                return false;
+            }
+
+            // Two points give a first frequency estimate, the PI loop refines it afterwards
+            m_drift = (offset_us - m_offset) / (double)(local_us - m_ref_local);
+            m_offset = offset_us;
+            m_ref_local = local_us;
+            m_state = ClockServoState::LOCKED;
+            break;
+        }
+        case ClockServoState::LOCKED: {
+            if (local_us <= m_ref_local) {
+                return false;
+            }
+
+            double dt = local_us - m_ref_local;
+            double predicted = offset_at(local_us);
+            double error = offset_us - predicted;
+            m_last_error = error;
+
+            if (std::fabs(error) > (double)m_step_threshold_us) {
+                // Too far off to slew, step the phase and estimate the frequency again
+                m_offset = offset_us;
+                m_drift = 0.0;
+                m_ref_local = local_us;
+                m_state = ClockServoState::FREQ_ESTIMATE;
+                break;
+            }
+
+            m_offset = predicted + m_kp * error;
+            m_drift += m_ki * error / dt;
+            m_ref_local = local_us;
+            break;
+        }
+    }
+
+    return true;
+}
+
+double ClockServo::offset_at(uint64_t local_us) const {
+    return m_offset + m_drift * ((double)local_us - (double)m_ref_local);
+}
+
+double ClockServo::get_freq_ratio() const {
+    // master = local - offset, so d(master)/d(local) = 1 - drift
+    return 1.0 - m_drift;
+}
+
+double ClockServo::get_last_error() const {
+    return m_last_error;
+}
+
+int64_t ClockServo::get_min_delay() const {
+    if (m_delay_count == 0) {
+        return 0;
+    }
+
+    return *std::min_element(m_delays.begin(), m_delays.begin() + m_delay_count);
+}
+
+ClockServoState ClockServo::get_state() const {
+    return m_state;
+}
@@ -0,0 +1,103 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef CLOCKSERVO_H
+#define CLOCKSERVO_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#define CLOCK_SERVO_WINDOW 8
+
+/**
+ * @enum ClockServoState
+ * @brief Lock state of a ClockServo
+ */
+enum class ClockServoState : uint8_t {
+    UNLOCKED,       /**< No sample yet */
+    FREQ_ESTIMATE,  /**< Phase known, waiting for a second sample to estimate the frequency */
+    LOCKED          /**< PI loop running */
+};
+
+/**
+ * @class ClockServo
+ * @brief Filters the offset measurements of the clock sync exchanges and estimates the phase offset and frequency
+ * drift of the local clock against the master. Samples whose path delay is well above the minimum delay seen in the
+ * last CLOCK_SERVO_WINDOW exchanges are rejected, the others feed a PI loop.
+ *
+ * Offsets follow the ClockSlave convention : offset = local time - master time, in us.
+ */
+class ClockServo {
+public:
+    /**
+     * Constructor
+     * @param kp Proportional gain
+     * @param ki Integral gain
+     * @param step_threshold_us Phase error above which the servo steps instead of slewing
+     * @param delay_margin_us Minimum tolerated path delay above the window minimum
+     */
+    ClockServo(double kp = 0.1, double ki = 0.01, uint64_t step_threshold_us = 1000, uint64_t delay_margin_us = 20);
+    ~ClockServo() = default;
+
+    /**
+     * Feed a sync exchange measurement
+     * @param offset_us Measured offset
+     * @param delay_us Measured one-way path delay
+     * @param local_us Local time of the measurement
+     * @return true if the sample was used, false if rejected as an outlier
+     */
+    bool sample(int64_t offset_us, int64_t delay_us, uint64_t local_us);
+
+    /**
+     * Estimated offset at a given local time
+     * @param local_us Local time in us
+     * @return Offset in us
+     */
+    double offset_at(uint64_t local_us) const;
+
+    /**
+     * @return Estimated master clock rate relative to the local clock (1.0 means no drift)
+     */
+    double get_freq_ratio() const;
+
+    /**
+     * @return Last filtered phase error in us
+     */
+    double get_last_error() const;
+
+    /**
+     * @return Minimum path delay in the current window
+     */
+    int64_t get_min_delay() const;
+
+    ClockServoState get_state() const;
+
+    /**
+     * Forget every measurement and go back to UNLOCKED
+     */
+    void reset();
+
+private:
+    double m_kp;
+    double m_ki;
+    uint64_t m_step_threshold_us;
+    uint64_t m_delay_margin_us;
+
+    ClockServoState m_state;
+
+    double m_offset;        // Offset at m_ref_local
+    double m_drift;         // Offset change per local us
+    uint64_t m_ref_local;
+    double m_last_error;
+
+    std::array<int64_t, CLOCK_SERVO_WINDOW> m_delays;
+    size_t m_delay_count;
+    size_t m_delay_idx;
+};
+
+
+
+#endif //CLOCKSERVO_H
@@ -5,12 +5,16 @@
 
 #include "ClockSlave.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
 ClockSlave::ClockSlave(uint16_t self_uid, const std::string &iface, std::shared_ptr<NetworkMapper> nmapper) {
     for (auto& t : m_tstamps) {
         t = 0;
     }
 
-    m_sync_socket = std::make_unique<LowLatSocket>(self_uid, nmapper);
+    m_sync_socket = std::make_shared<LowLatSocket>(self_uid, nmapper);
     if (!m_sync_socket->init_socket(iface, EthProtocol::ETH_PROTO_OANSYNC)) {
 #ifdef __linux__
         std::cerr << "Failed to init sync iface" << std::endl;
@@ -18,49 +22,173 @@ ClockSlave::ClockSlave(uint16_t self_uid, const std::string &iface, std::shared_
     }
 
     m_nmapper = nmapper;
-    m_ck_offset = 0;
+    m_last_network_us = 0;
+    m_sync_seq = 0;
+    m_exchange_master = 0;
+    m_servo_master = 0;
+    m_awaiting_follow_up = false;
+    m_awaiting_resp = false;
+    m_holdover_timeout_us = 1000000;
+}
+
+ClockSlave::ClockSlave(std::shared_ptr<LowLatSocket> sync_socket, std::shared_ptr<NetworkMapper> nmapper) {
+    for (auto& t : m_tstamps) {
+        t = 0;
+    }
+
+    m_sync_socket = std::move(sync_socket);
+    m_nmapper = nmapper;
+    m_last_network_us = 0;
+    m_sync_seq = 0;
+    m_exchange_master = 0;
+    m_servo_master = 0;
+    m_awaiting_follow_up = false;
+    m_awaiting_resp = false;
+    m_holdover_timeout_us = 1000000;
 }
 
 void ClockSlave::sync_process() {
-    LowLatPacket<ClockSyncPacket> pck{};
-    if (m_sync_socket->receive_data(&pck) <= 0) {
+    alignas(std::max_align_t) uint8_t raw_packet_buffer[sizeof(LowLatPacket<ClockSyncPacket>)];
+
+    int recv_bytes = m_sync_socket->receive_data_raw(reinterpret_cast<char*>(raw_packet_buffer), sizeof(raw_packet_buffer));
+    if (recv_bytes <= 0) {
         return;
     }
 
-    if (pck.payload.header.type == PacketType::CLOCK_SYNC) {
-        switch (pck.payload.packet_data.packet_state) {
-            case ClockSyncState::CKSYNC_SYNC:
-                m_tstamps[0] = pck.payload.header.timestamp;  // t1
-                m_tstamps[1] = NetworkMapper::local_now_us(); // t2
-                send_delay_req(pck.llhdr.sender_uid);
-                break;
-            case ClockSyncState::CKSYNC_DELAY_RESP:
-                m_tstamps[3] = pck.payload.header.timestamp; // t4
-                calc_ck_offset();
-                break;
-            default:
-                break;
+    PacketView<ClockSync> view{raw_packet_buffer, (size_t)recv_bytes};
+    if (view.valid()) {
+        process_packet(view.packet(), view.llhdr().sender_uid);
+    }
+}
+
+void ClockSlave::process_packet(ClockSyncPacket &packet, uint16_t sender_uid) {
+    switch (packet.packet_data.packet_state) {
+        case ClockSyncState::CKSYNC_SYNC: {
+            m_tstamps[1] = oals::tstamp::now_epoch_us(); // t2
+            m_tstamps[0] = packet.header.timestamp;  // t1, coarse if two-step
+
+            // Previous exchange never completed, or whole exchanges were missed
+            if (m_awaiting_resp || m_awaiting_follow_up) {
+                m_stats.record_lost();
+            }
+
+            uint16_t seq_gap = packet.packet_data.seq_id - m_sync_seq;
+            if (m_stats.get_exchanges() > 0 && seq_gap > 1 && seq_gap < 1024) {
+                m_stats.record_lost(seq_gap - 1);
+            }
+
+            m_sync_seq = packet.packet_data.seq_id;
+            m_exchange_master = sender_uid;
+            m_awaiting_resp = false;
+            m_awaiting_follow_up = packet.packet_data.flags & CKSYNC_FLAG_TWO_STEP;
+
+            if (!m_awaiting_follow_up) {
+                send_delay_req(sender_uid);
+            }
+            break;
         }
+        case ClockSyncState::CKSYNC_FOLLOW_UP:
+            if (m_awaiting_follow_up && packet.packet_data.seq_id == m_sync_seq) {
+                m_tstamps[0] = packet.header.timestamp; // precise t1
+                m_awaiting_follow_up = false;
+                send_delay_req(sender_uid);
+            }
+            break;
+        case ClockSyncState::CKSYNC_DELAY_RESP:
+            // Ignore responses to an older exchange
+            if (m_awaiting_resp && packet.packet_data.seq_id == m_sync_seq) {
+                m_tstamps[3] = packet.header.timestamp; // t4
+                m_awaiting_resp = false;
+                calc_ck_offset();
+            }
+            break;
+        default:
+            break;
     }
 }
 
 void ClockSlave::send_delay_req(uint16_t dest) {
     ClockSyncPacket pck{};
     pck.header.type = PacketType::CLOCK_SYNC;
-    pck.header.timestamp = NetworkMapper::local_now_us();
+    pck.header.version = OAN_PROTOCOL_VERSION;
+    pck.header.timestamp = oals::tstamp::now_epoch_us();
     pck.packet_data.packet_state = ClockSyncState::CKSYNC_DELAY_REQ;
+    pck.packet_data.seq_id = m_sync_seq;
+
+    // Let the master keep per-slave quality metrics
+    pck.packet_data.report_offset_ns = std::clamp<int64_t>(m_stats.get_last_offset_ns(), INT32_MIN, INT32_MAX);
+    pck.packet_data.report_delay_ns = std::clamp<int64_t>(m_stats.get_last_delay_ns(), INT32_MIN, INT32_MAX);
+    pck.packet_data.report_freq_error_ppb = std::clamp<int64_t>(m_stats.get_last_freq_error_ppb(), INT32_MIN, INT32_MAX);
 
     m_sync_socket->send_data(pck, dest);
     m_tstamps[2] = pck.header.timestamp; // t3
+    m_awaiting_resp = true;
 }
 
 void ClockSlave::calc_ck_offset() {
     int64_t delay1 = m_tstamps[1] - m_tstamps[0];
     int64_t delay2 = m_tstamps[3] - m_tstamps[2];
 
-    m_ck_offset = (delay1 - delay2) / 2;
+    int64_t delay = (delay1 + delay2) / 2;
+
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_servo_mutex};
+#endif // NO_THREADS
+
+    // New master after a failover: its path delay and drift estimate differ, restart from its first measurement.
+    // The network time clamp stays, a backward step holds the network time for the step duration.
+    if (m_exchange_master != m_servo_master) {
+        m_servo.reset();
+        m_servo_master = m_exchange_master;
+    }
+
+    if (m_servo.sample((delay1 - delay2) / 2, delay, m_tstamps[1])) {
+        m_stats.record_exchange(
+            std::llround(m_servo.get_last_error() * 1000.0),
+            delay * 1000,
+            std::llround((m_servo.get_freq_ratio() - 1.0) * 1e9),
+            oals::tstamp::now_us()
+        );
+    } else {
+        m_stats.record_rejected();
+    }
+}
+
+int64_t ClockSlave::get_ck_offset() {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_servo_mutex};
+#endif // NO_THREADS
+    return std::llround(m_servo.offset_at(oals::tstamp::now_epoch_us()));
+}
+
+double ClockSlave::get_freq_ratio() {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_servo_mutex};
+#endif // NO_THREADS
+    return m_servo.get_freq_ratio();
+}
+
+uint64_t ClockSlave::now_network_us() {
+    uint64_t local = oals::tstamp::now_epoch_us();
+
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_servo_mutex};
+#endif // NO_THREADS
+    uint64_t network = local - std::llround(m_servo.offset_at(local));
+
+    // Servo corrections must not make the network time go backwards
+    m_last_network_us = std::max(m_last_network_us, network);
+    return m_last_network_us;
+}
+
+const ClockSyncStats &ClockSlave::get_stats() const {
+    return m_stats;
+}
+
+ClockHoldoverState ClockSlave::get_holdover_state() const {
+    return m_stats.holdover_state(oals::tstamp::now_us(), m_holdover_timeout_us);
 }
 
-int64_t ClockSlave::get_ck_offset() const {
-    return m_ck_offset;
+void ClockSlave::set_holdover_timeout(uint64_t timeout_us) {
+    m_holdover_timeout_us = timeout_us;
 }
@@ -9,24 +9,92 @@
 #include "NetworkMapper.h"
 #include "netutils/LowLatSocket.h"
 #include "clock.h"
+#include "ClockServo.h"
+#include "ClockStats.h"
+#include "packet_view.h"
+
+#ifndef NO_THREADS
+#include <mutex>
+#endif // NO_THREADS
 
 class ClockSlave {
 public:
     ClockSlave(uint16_t self_uid, const std::string& iface, std::shared_ptr<NetworkMapper> nmapper);
+
+    /**
+     * Constructor for a slave fed by the owner of an existing sync socket, see process_packet
+     * @param sync_socket Socket used to send the DELAY_REQ
+     * @param nmapper Local network mapper
+     */
+    ClockSlave(std::shared_ptr<LowLatSocket> sync_socket, std::shared_ptr<NetworkMapper> nmapper);
     ~ClockSlave() = default;
 
     void sync_process();
-    int64_t get_ck_offset() const;
+
+    /**
+     * Process a sync packet received by the caller. Used by standby masters, which share their socket.
+     * @param packet Sync packet
+     * @param sender_uid Packet sender
+     */
+    void process_packet(ClockSyncPacket& packet, uint16_t sender_uid);
+
+    /**
+     * Filtered offset between the local clock and the master clock
+     * @return Local time - master time, in us
+     */
+    int64_t get_ck_offset();
+
+    /**
+     * @return Estimated master clock rate relative to the local clock
+     */
+    double get_freq_ratio();
+
+    /**
+     * Network (master) time, extrapolated from the servo between two sync exchanges.
+     * Never goes backwards. Local time since the Unix epoch until the first exchange, see oals::tstamp::now_epoch_us.
+     * @return Network time in us
+     */
+    uint64_t now_network_us();
+
+    /**
+     * @return Sync quality metrics of this slave
+     */
+    const ClockSyncStats& get_stats() const;
+
+    /**
+     * Holdover state of the local time base. The audio side should react when the clock leaves LOCKED.
+     * @return FREE_RUN until the first good exchange, HOLDOVER when no good exchange happened within the holdover timeout
+     */
+    ClockHoldoverState get_holdover_state() const;
+
+    /**
+     * @param timeout_us Time without a good exchange after which the clock is in holdover
+     */
+    void set_holdover_timeout(uint64_t timeout_us);
 
 private:
     void send_delay_req(uint16_t dest);
     void calc_ck_offset();
 
     std::shared_ptr<NetworkMapper> m_nmapper;
-    std::unique_ptr<LowLatSocket> m_sync_socket;
+    std::shared_ptr<LowLatSocket> m_sync_socket;
 
     uint64_t m_tstamps[4];
-    int64_t m_ck_offset;
+    uint16_t m_sync_seq;
+    uint16_t m_exchange_master;     // Sender of the SYNC of the current exchange
+    uint16_t m_servo_master;        // Master the servo measurements come from
+    bool m_awaiting_follow_up;
+    bool m_awaiting_resp;
+
+    ClockSyncStats m_stats;
+    uint64_t m_holdover_timeout_us;
+
+    ClockServo m_servo;
+    uint64_t m_last_network_us;
+
+#ifndef NO_THREADS
+    std::mutex m_servo_mutex;
+#endif // NO_THREADS
 };
 
 
@@ -0,0 +1,154 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "ClockStats.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+uint64_t HistogramSnapshot::percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)(p * count + 0.5));
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return i == 0 ? 0 : std::min<uint64_t>(max, (1ULL << i) - 1);
+        }
+    }
+
+    return max;
+}
+
+AtomicHistogram::AtomicHistogram() {
+    reset();
+}
+
+void AtomicHistogram::record(uint64_t value) {
+    size_t bucket = std::min<size_t>(std::bit_width(value), CLOCK_STATS_BUCKETS - 1);
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+HistogramSnapshot AtomicHistogram::snapshot() const {
+    HistogramSnapshot snap{};
+
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+        snap.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    snap.count = m_count.load(std::memory_order_relaxed);
+    snap.sum = m_sum.load(std::memory_order_relaxed);
+    snap.max = m_max.load(std::memory_order_relaxed);
+
+    return snap;
+}
+
+void AtomicHistogram::reset() {
+    for (auto& b : m_buckets) {
+        b.store(0, std::memory_order_relaxed);
+    }
+
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+ClockSyncStats::ClockSyncStats() {
+    m_last_offset_ns = 0;
+    m_last_delay_ns = 0;
+    m_last_freq_error_ppb = 0;
+
+    m_exchanges = 0;
+    m_lost = 0;
+    m_rejected = 0;
+    m_last_good_sync_us = 0;
+}
+
+void ClockSyncStats::record_exchange(int64_t offset_ns, int64_t delay_ns, int64_t freq_error_ppb, uint64_t now_us) {
+    m_offset_ns.record(std::llabs(offset_ns));
+    m_delay_ns.record(std::max<int64_t>(delay_ns, 0));
+    m_freq_error_ppb.record(std::llabs(freq_error_ppb));
+
+    m_last_offset_ns.store(offset_ns, std::memory_order_relaxed);
+    m_last_delay_ns.store(delay_ns, std::memory_order_relaxed);
+    m_last_freq_error_ppb.store(freq_error_ppb, std::memory_order_relaxed);
+
+    m_exchanges.fetch_add(1, std::memory_order_relaxed);
+    m_last_good_sync_us.store(now_us, std::memory_order_relaxed);
+}
+
+void ClockSyncStats::record_lost(uint32_t count) {
+    m_lost.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ClockSyncStats::record_rejected() {
+    m_rejected.fetch_add(1, std::memory_order_relaxed);
+}
+
+HistogramSnapshot ClockSyncStats::get_offset_histogram() const {
+    return m_offset_ns.snapshot();
+}
+
+HistogramSnapshot ClockSyncStats::get_delay_histogram() const {
+    return m_delay_ns.snapshot();
+}
+
+HistogramSnapshot ClockSyncStats::get_freq_error_histogram() const {
+    return m_freq_error_ppb.snapshot();
+}
+
+int64_t ClockSyncStats::get_last_offset_ns() const {
+    return m_last_offset_ns.load(std::memory_order_relaxed);
+}
+
+int64_t ClockSyncStats::get_last_delay_ns() const {
+    return m_last_delay_ns.load(std::memory_order_relaxed);
+}
+
+int64_t ClockSyncStats::get_last_freq_error_ppb() const {
+    return m_last_freq_error_ppb.load(std::memory_order_relaxed);
+}
+
+uint64_t ClockSyncStats::get_exchanges() const {
+    return m_exchanges.load(std::memory_order_relaxed);
+}
+
+uint64_t ClockSyncStats::get_lost() const {
+    return m_lost.load(std::memory_order_relaxed);
+}
+
+uint64_t ClockSyncStats::get_rejected() const {
+    return m_rejected.load(std::memory_order_relaxed);
+}
+
+uint64_t ClockSyncStats::since_last_good_sync_us(uint64_t now_us) const {
+    uint64_t last = m_last_good_sync_us.load(std::memory_order_relaxed);
+    if (last == 0) {
+        return UINT64_MAX;
+    }
+
+    return now_us > last ? now_us - last : 0;
+}
+
+ClockHoldoverState ClockSyncStats::holdover_state(uint64_t now_us, uint64_t holdover_timeout_us) const {
+    uint64_t since = since_last_good_sync_us(now_us);
+
+    if (since == UINT64_MAX) {
+        return ClockHoldoverState::FREE_RUN;
+    }
+
+    return since > holdover_timeout_us ? ClockHoldoverState::HOLDOVER : ClockHoldoverState::LOCKED;
+}
@@ -0,0 +1,126 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef CLOCKSTATS_H
+#define CLOCKSTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "clock.h"
+
+#define CLOCK_STATS_BUCKETS 40
+
+/**
+ * @struct HistogramSnapshot
+ * @brief Copy of an AtomicHistogram at a given time
+ */
+struct HistogramSnapshot {
+    std::array<uint64_t, CLOCK_STATS_BUCKETS> buckets;  /**< Bucket i counts values in [2^(i-1), 2^i), bucket 0 counts 0 */
+    uint64_t count;                                     /**< Recorded values */
+    uint64_t sum;                                       /**< Sum of the recorded values */
+    uint64_t max;                                       /**< Largest recorded value */
+
+    /**
+     * @param p Percentile, between 0 and 1
+     * @return Upper bound of the bucket holding the given percentile
+     */
+    uint64_t percentile(double p) const;
+};
+
+/**
+ * @class AtomicHistogram
+ * @brief Log2 bucketed histogram of unsigned values. Recording and reading never lock, so readers on other threads
+ * never stall the sync thread.
+ */
+class AtomicHistogram {
+public:
+    AtomicHistogram();
+
+    void record(uint64_t value);
+    HistogramSnapshot snapshot() const;
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, CLOCK_STATS_BUCKETS> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+/**
+ * @enum ClockHoldoverState
+ * @brief Quality of the time base of a node
+ */
+enum class ClockHoldoverState : uint8_t {
+    FREE_RUN,   /**< Never synchronized */
+    LOCKED,     /**< Synchronized recently */
+    HOLDOVER    /**< Was synchronized but lost its master, drifting on its last frequency estimate */
+};
+
+/**
+ * @class ClockSyncStats
+ * @brief Clock sync quality metrics of one slave, recorded by the slave itself and by the master from slave reports
+ */
+class ClockSyncStats {
+public:
+    ClockSyncStats();
+
+    /**
+     * Record a completed exchange
+     * @param offset_ns Filtered phase error
+     * @param delay_ns Path delay
+     * @param freq_error_ppb Frequency error against the master
+     * @param now_us Local time of the exchange
+     */
+    void record_exchange(int64_t offset_ns, int64_t delay_ns, int64_t freq_error_ppb, uint64_t now_us);
+
+    void record_lost(uint32_t count = 1);
+    void record_rejected();
+
+    HistogramSnapshot get_offset_histogram() const;
+    HistogramSnapshot get_delay_histogram() const;
+    HistogramSnapshot get_freq_error_histogram() const;
+
+    int64_t get_last_offset_ns() const;
+    int64_t get_last_delay_ns() const;
+    int64_t get_last_freq_error_ppb() const;
+
+    uint64_t get_exchanges() const;
+    uint64_t get_lost() const;
+    uint64_t get_rejected() const;
+
+    /**
+     * @param now_us Current local time
+     * @return Time since the last good exchange in us, UINT64_MAX if there was none
+     */
+    uint64_t since_last_good_sync_us(uint64_t now_us) const;
+
+    /**
+     * @param now_us Current local time
+     * @param holdover_timeout_us Time without a good exchange after which the clock is in holdover
+     * @return Holdover state
+     */
+    ClockHoldoverState holdover_state(uint64_t now_us, uint64_t holdover_timeout_us) const;
+
+private:
+    AtomicHistogram m_offset_ns;
+    AtomicHistogram m_delay_ns;
+    AtomicHistogram m_freq_error_ppb;
+
+    std::atomic<int64_t> m_last_offset_ns;
+    std::atomic<int64_t> m_last_delay_ns;
+    std::atomic<int64_t> m_last_freq_error_ppb;
+
+    std::atomic<uint64_t> m_exchanges;
+    std::atomic<uint64_t> m_lost;
+    std::atomic<uint64_t> m_rejected;
+    std::atomic<uint64_t> m_last_good_sync_us;
+};
+
+
+
+#endif //CLOCKSTATS_H
@@ -0,0 +1,91 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "ControlCoalescer.h"
+
+#include "NetworkMapper.h"
+
+ControlCoalescer::ControlCoalescer(std::shared_ptr<AudioRouter> router, uint64_t tick_us) {
+    m_router = std::move(router);
+    m_tick_us = tick_us;
+    m_last_flush = 0;
+    m_wheel = nullptr;
+    m_flush_timer = 0;
+}
+
+ControlCoalescer::~ControlCoalescer() {
+    unschedule();
+}
+
+void ControlCoalescer::schedule_on(TimerWheel &wheel) {
+    unschedule();
+
+    m_wheel = &wheel;
+    m_flush_timer = wheel.schedule(m_tick_us, [this]() {
+        flush();
+    }, m_tick_us);
+}
+
+void ControlCoalescer::unschedule() {
+    if (m_wheel != nullptr) {
+        m_wheel->cancel(m_flush_timer);
+        m_wheel = nullptr;
+    }
+}
+
+uint32_t ControlCoalescer::make_control_key(const ControlData &data) {
+    return ((uint32_t)data.channel << 24) | ((uint32_t)data.elem_index << 16) | data.control_id;
+}
+
+void ControlCoalescer::push(const ControlData &data, uint16_t dest_uid) {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_coalescer_mutex};
+#endif // NO_THREADS
+
+    PendingBatch& batch = m_pending[dest_uid];
+    uint32_t key = make_control_key(data);
+
+    auto it = batch.index.find(key);
+    if (it != batch.index.end()) {
+        batch.entries[it->second] = data;
+    } else {
+        batch.index[key] = batch.entries.size();
+        batch.entries.push_back(data);
+    }
+}
+
+void ControlCoalescer::update() {
+    uint64_t now = oals::tstamp::now_us();
+    if (now - m_last_flush < m_tick_us) {
+        return;
+    }
+
+    m_last_flush = now;
+    flush();
+}
+
+void ControlCoalescer::flush() {
+    std::unordered_map<uint16_t, PendingBatch> pending;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_coalescer_mutex};
+#endif // NO_THREADS
+        pending.swap(m_pending);
+    }
+
+    for (auto& [dest_uid, batch] : pending) {
+        // Values are sent in their first-push order, split across as many frames as needed
+        for (size_t offset = 0; offset < batch.entries.size(); offset += CONTROL_BATCH_MAX_ENTRIES) {
+            ControlBatchPacket pck{};
+            pck.header.type = PacketType::CONTROL_BATCH;
+            pck.header.version = OAN_PROTOCOL_VERSION;
+            pck.packet_data.count = std::min<size_t>(CONTROL_BATCH_MAX_ENTRIES, batch.entries.size() - offset);
+
+            memcpy(pck.packet_data.entries, batch.entries.data() + offset, pck.packet_data.count * sizeof(ControlData));
+            m_router->send_control_packet(pck, dest_uid);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef CONTROLCOALESCER_H
+#define CONTROLCOALESCER_H
+
+#ifndef NO_THREADS
+#include <mutex>
+#endif // NO_THREADS
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "AudioRouter.h"
+#include "TimerWheel.h"
+
+/**
+ * @class ControlCoalescer
+ * @brief Sender side control rate limiter. Control values pushed during a tick are merged, last value wins per
+ * (channel, elem_index, control_id), and sent as ControlBatch packets once per tick.
+ */
+class ControlCoalescer {
+public:
+    /**
+     * Constructor
+     * @param router Router used to send the batches
+     * @param tick_us Minimum delay between two flushes in us
+     */
+    ControlCoalescer(std::shared_ptr<AudioRouter> router, uint64_t tick_us = 10000);
+    ~ControlCoalescer();
+
+    /**
+     * Queue a control value. Replaces any value queued during the current tick for the same control.
+     * @param data Control value
+     * @param dest_uid Receiver UID
+     */
+    void push(const ControlData& data, uint16_t dest_uid);
+
+    /**
+     * Flush pending values if the tick has elapsed
+     */
+    void update();
+
+    /**
+     * Send every pending value now
+     */
+    void flush();
+
+    /**
+     * Flush from a timer wheel every tick, instead of polling update
+     * @param wheel Timer wheel, must outlive the coalescer or unschedule must be called first
+     */
+    void schedule_on(TimerWheel& wheel);
+
+    /**
+     * Cancel the timer installed by schedule_on. Called by the destructor.
+     */
+    void unschedule();
+
+private:
+    struct PendingBatch {
+        std::vector<ControlData> entries;
+        std::unordered_map<uint32_t, size_t> index;
+    };
+
+    static uint32_t make_control_key(const ControlData& data);
+
+    std::shared_ptr<AudioRouter> m_router;
+    uint64_t m_tick_us;
+    TimerWheel* m_wheel;
+    TimerId m_flush_timer;
+    uint64_t m_last_flush;
+
+    std::unordered_map<uint16_t, PendingBatch> m_pending;
+
+#ifndef NO_THREADS
+    std::mutex m_coalescer_mutex;
+#endif // NO_THREADS
+};
+
+
+
+#endif //CONTROLCOALESCER_H
@@ -0,0 +1,279 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "ControlStateCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "AudioRouter.h"
+
+// Worst case entry: 5 bytes key delta, type, 16 bytes of custom data
+static constexpr size_t MAX_ENTRY_BYTES = 5 + 1 + sizeof(ControlData::data);
+
+static size_t value_size(DataTypes type) {
+    switch (type) {
+        case DataTypes::INT8:
+            return 1;
+        case DataTypes::INT16:
+            return 2;
+        case DataTypes::INT32:
+        case DataTypes::FLOAT:
+            return 4;
+        default:
+            return sizeof(ControlData::data);
+    }
+}
+
+static DataTypes encoded_type(const ControlData& data) {
+    // Scalars only use the first word, anything else is sent whole so that no value is truncated
+    if (data.data[1] != 0 || data.data[2] != 0 || data.data[3] != 0) {
+        return DataTypes::CUSTOM;
+    }
+
+    if (data.control_type == DataTypes::INT8 && data.data[0] > UINT8_MAX) {
+        return DataTypes::CUSTOM;
+    }
+
+    if (data.control_type == DataTypes::INT16 && data.data[0] > UINT16_MAX) {
+        return DataTypes::CUSTOM;
+    }
+
+    return data.control_type;
+}
+
+ControlStateCache::ControlStateCache() {
+    m_version = 0;
+    m_reset_version = 0;
+}
+
+uint32_t ControlStateCache::make_control_key(uint8_t channel, uint8_t elem_index, uint16_t control_id) {
+    return ((uint32_t)channel << 24) | ((uint32_t)elem_index << 16) | control_id;
+}
+
+bool ControlStateCache::apply(const ControlData &data) {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_cache_mutex};
+#endif // NO_THREADS
+
+    uint32_t key = make_control_key(data.channel, data.elem_index, data.control_id);
+    auto it = m_controls.find(key);
+
+    if (it != m_controls.end() && it->second.data.control_type == data.control_type
+        && memcmp(it->second.data.data, data.data, sizeof(data.data)) == 0) {
+        return false;
+    }
+
+    m_controls[key] = Entry{data, ++m_version};
+    return true;
+}
+
+void ControlStateCache::apply(const ControlBatch &batch) {
+    uint8_t count = std::min<uint8_t>(batch.count, CONTROL_BATCH_MAX_ENTRIES);
+
+    for (uint8_t i = 0; i < count; i++) {
+        apply(batch.entries[i]);
+    }
+}
+
+std::optional<ControlData> ControlStateCache::get(uint8_t channel, uint8_t elem_index, uint16_t control_id) const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_cache_mutex};
+#endif // NO_THREADS
+
+    auto it = m_controls.find(make_control_key(channel, elem_index, control_id));
+    if (it == m_controls.end()) {
+        return {};
+    }
+
+    return it->second.data;
+}
+
+uint32_t ControlStateCache::version() const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_cache_mutex};
+#endif // NO_THREADS
+    return m_version;
+}
+
+size_t ControlStateCache::size() const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_cache_mutex};
+#endif // NO_THREADS
+    return m_controls.size();
+}
+
+void ControlStateCache::clear() {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_cache_mutex};
+#endif // NO_THREADS
+    m_controls.clear();
+    m_reset_version = ++m_version;
+}
+
+std::vector<ControlStateChunkPacket> ControlStateCache::encode(uint32_t since) const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_cache_mutex};
+#endif // NO_THREADS
+
+    std::vector<ControlStateChunkPacket> chunks;
+    uint32_t previous_key = 0;
+
+    // The requester saw controls removed since, or another incarnation of this node: send everything
+    bool full = since == 0 || since < m_reset_version || since > m_version;
+
+    auto new_chunk = [&]() {
+        ControlStateChunkPacket& pck = chunks.emplace_back();
+        memset(&pck, 0, sizeof(pck));
+        pck.header.type = PacketType::CONTROL_STATE;
+        pck.header.version = OAN_PROTOCOL_VERSION;
+        pck.packet_data.version = m_version;
+        pck.packet_data.since = full ? 0 : since;
+        pck.packet_data.seq = chunks.size() - 1;
+        pck.packet_data.full = full;
+        previous_key = 0;
+    };
+
+    new_chunk();
+
+    for (auto& [key, entry] : m_controls) {
+        if (!full && entry.version <= since) {
+            continue;
+        }
+
+        if (chunks.back().packet_data.size + MAX_ENTRY_BYTES > CONTROL_STATE_CHUNK_BYTES) {
+            new_chunk();
+        }
+
+        ControlStateChunk& chunk = chunks.back().packet_data;
+        uint8_t* out = chunk.data + chunk.size;
+
+        // Keys are sorted, consecutive controls of an element take a single byte
+        uint32_t delta = key - previous_key;
+        do {
+            uint8_t byte = delta & 0x7F;
+            delta >>= 7;
+            *out++ = byte | (delta != 0 ? 0x80 : 0);
+        } while (delta != 0);
+
+        DataTypes type = encoded_type(entry.data);
+        *out++ = (uint8_t)type;
+        memcpy(out, entry.data.data, value_size(type));
+        out += value_size(type);
+
+        chunk.size = out - chunk.data;
+        chunk.count++;
+        previous_key = key;
+    }
+
+    chunks.back().packet_data.last = 1;
+    return chunks;
+}
+
+void ControlStateCache::send_snapshot(AudioRouter &router, uint16_t dest_uid, uint32_t since) const {
+    // Encoded under the lock, sent without it
+    for (auto& chunk : encode(since)) {
+        router.send_control_packet(chunk, dest_uid);
+    }
+}
+
+size_t ControlStateCache::decode(const ControlStateChunk &chunk, const std::function<void(const ControlData &)> &callback) {
+    size_t size = std::min<size_t>(chunk.size, CONTROL_STATE_CHUNK_BYTES);
+    size_t pos = 0;
+    size_t decoded = 0;
+    uint32_t key = 0;
+
+    while (decoded < chunk.count && pos < size) {
+        uint32_t delta = 0;
+        uint8_t shift = 0;
+        uint8_t byte;
+
+        do {
+            if (pos >= size || shift > 28) {
+                return decoded;
+            }
+
+            byte = chunk.data[pos++];
+            delta |= (uint32_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        if (pos >= size || chunk.data[pos] > (uint8_t)DataTypes::CUSTOM) {
+            return decoded;
+        }
+
+        DataTypes type = (DataTypes)chunk.data[pos++];
+        if (pos + value_size(type) > size) {
+            return decoded;
+        }
+
+        key += delta;
+
+        ControlData data{};
+        data.channel = key >> 24;
+        data.elem_index = (key >> 16) & 0xFF;
+        data.control_id = key & 0xFFFF;
+        data.control_type = type;
+        memcpy(data.data, chunk.data + pos, value_size(type));
+        pos += value_size(type);
+
+        callback(data);
+        decoded++;
+    }
+
+    return decoded;
+}
+
+ControlQueryPacket ControlStateCache::make_sync_query(uint32_t since) {
+    ControlQueryPacket pck{};
+    pck.header.type = PacketType::CONTROL_QUERY;
+    pck.header.version = OAN_PROTOCOL_VERSION;
+    pck.packet_data.qtype = ControlQueryType::CONTROL_STATE_SYNC;
+    pck.packet_data.flags = since;
+
+    return pck;
+}
+
+uint32_t ControlStateReplica::synced_version(uint16_t node_uid) const {
+    auto it = m_nodes.find(node_uid);
+    return it == m_nodes.end() ? 0 : it->second.synced;
+}
+
+bool ControlStateReplica::receive(uint16_t node_uid, const ControlStateChunk &chunk, const std::function<void(const ControlData &)> &callback,
+                                  const std::function<void()> &on_full) {
+    NodeSync& node = m_nodes.try_emplace(node_uid, NodeSync{0, 0, 0, false}).first->second;
+
+    // First chunk of a snapshot, or a chunk of another one than expected
+    if (chunk.seq == 0 || chunk.version != node.pending) {
+        node.pending = chunk.version;
+        node.next_seq = 0;
+        node.broken = false;
+    }
+
+    if (chunk.seq != node.next_seq) {
+        node.broken = true;
+    }
+    node.next_seq = chunk.seq + 1;
+
+    // A lost first chunk leaves the snapshot broken, the next sync asks for a full one again
+    if (chunk.full && chunk.seq == 0 && on_full) {
+        on_full();
+    }
+
+    // Values are absolute, applying a partial snapshot is safe, only the version must not advance
+    ControlStateCache::decode(chunk, callback);
+
+    // Missing chunks, or a snapshot based on a version we do not have: ask again from the last complete version
+    if (chunk.last == 0 || node.broken || (chunk.since != 0 && chunk.since != node.synced)) {
+        return false;
+    }
+
+    node.synced = chunk.version;
+    return true;
+}
+
+void ControlStateReplica::forget(uint16_t node_uid) {
+    m_nodes.erase(node_uid);
+}
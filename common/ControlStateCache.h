@@ -0,0 +1,165 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef CONTROLSTATECACHE_H
+#define CONTROLSTATECACHE_H
+
+#ifndef NO_THREADS
+#include <mutex>
+#endif // NO_THREADS
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "packet_structs.h"
+
+class AudioRouter;
+
+/**
+ * @class ControlStateCache
+ * @brief Current value of every control of a node, keyed by (channel, elem_index, control_id). Each change bumps the
+ * cache version and stamps the control with it, so that a control surface joining late gets the whole state in a few
+ * ControlStateChunk frames, and a surface already in sync only gets the controls changed after its version. Join
+ * time only depends on the number of controls, not on the show history.
+ */
+class ControlStateCache {
+public:
+    ControlStateCache();
+    ~ControlStateCache() = default;
+
+    /**
+     * Record a control value
+     * @param data Control value
+     * @return true if the value changed
+     */
+    bool apply(const ControlData& data);
+
+    /**
+     * Record every value of a batch
+     * @param batch Control batch
+     */
+    void apply(const ControlBatch& batch);
+
+    /**
+     * @return Current value of a control, if it was ever set
+     */
+    std::optional<ControlData> get(uint8_t channel, uint8_t elem_index, uint16_t control_id) const;
+
+    /**
+     * @return Current state version, 0 while empty
+     */
+    uint32_t version() const;
+
+    /**
+     * @return Number of controls stored
+     */
+    size_t size() const;
+
+    /**
+     * Forget every control, for instance when the pipes are reset. The version keeps increasing and becomes the reset
+     * version: surfaces syncing from an older version get a full snapshot.
+     */
+    void clear();
+
+    /**
+     * Encode the controls changed after a version. A full snapshot, flagged as such, is sent instead when the
+     * receiver has no version, a version older than the last clear or a version of another incarnation of the node.
+     * @param since Version the receiver already has, 0 for a full snapshot
+     * @return Snapshot chunks, at least one (an empty snapshot still tells the receiver its version)
+     */
+    std::vector<ControlStateChunkPacket> encode(uint32_t since) const;
+
+    /**
+     * Answer a CONTROL_STATE_SYNC query
+     * @param router Router used to send the chunks
+     * @param dest_uid Requesting surface
+     * @param since Version the surface already has
+     */
+    void send_snapshot(AudioRouter& router, uint16_t dest_uid, uint32_t since) const;
+
+    /**
+     * Decode a snapshot chunk
+     * @param chunk Received chunk
+     * @param callback Called for each control value of the chunk
+     * @return Number of decoded values, malformed trailing data is ignored
+     */
+    static size_t decode(const ControlStateChunk& chunk, const std::function<void(const ControlData&)>& callback);
+
+    /**
+     * Build the query asking a node for its control state
+     * @param since Version already known, 0 for a full snapshot
+     */
+    static ControlQueryPacket make_sync_query(uint32_t since);
+
+private:
+    struct Entry {
+        ControlData data;
+        uint32_t version;
+    };
+
+    static uint32_t make_control_key(uint8_t channel, uint8_t elem_index, uint16_t control_id);
+
+    std::map<uint32_t, Entry> m_controls;   // Ordered, snapshots are delta encoded by key
+    uint32_t m_version;
+    uint32_t m_reset_version;               // Version set by the last clear, deltas from before it miss removals
+
+#ifndef NO_THREADS
+    mutable std::mutex m_cache_mutex;
+#endif // NO_THREADS
+};
+
+/**
+ * @class ControlStateReplica
+ * @brief Surface side bookkeeping of the control state of each node. Tracks the version each node is known up to and
+ * detects lost chunks, so that the next query asks for what is missing only. Values are handed to a callback,
+ * the surface keeps them where it needs.
+ */
+class ControlStateReplica {
+public:
+    ControlStateReplica() = default;
+    ~ControlStateReplica() = default;
+
+    /**
+     * @param node_uid Node UID
+     * @return Version to put in the next CONTROL_STATE_SYNC query to that node
+     */
+    uint32_t synced_version(uint16_t node_uid) const;
+
+    /**
+     * Process a received chunk
+     * @param node_uid Sender UID
+     * @param chunk Received chunk
+     * @param callback Called for each control value
+     * @param on_full Called before the values of a full snapshot: the surface drops every value it holds for the
+     * node, the controls missing from the snapshot were removed
+     * @return true when the chunk completes a snapshot without loss, the node is then in sync up to its version
+     */
+    bool receive(uint16_t node_uid, const ControlStateChunk& chunk, const std::function<void(const ControlData&)>& callback,
+                 const std::function<void()>& on_full = nullptr);
+
+    /**
+     * Forget a node, its next sync is a full one
+     * @param node_uid Node UID
+     */
+    void forget(uint16_t node_uid);
+
+private:
+    struct NodeSync {
+        uint32_t synced;        // Version fully received
+        uint32_t pending;       // Version of the snapshot being received
+        uint16_t next_seq;      // Next expected chunk
+        bool broken;            // A chunk of the pending snapshot was lost
+    };
+
+    std::unordered_map<uint16_t, NodeSync> m_nodes;
+};
+
+
+
+#endif //CONTROLSTATECACHE_H
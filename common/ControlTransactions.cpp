@@ -0,0 +1,379 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "ControlTransactions.h"
+
+#include "NetworkMapper.h"
+
+static constexpr uint32_t SLOT_MASK = CONTROL_TRANSACTION_CAPACITY - 1;
+static constexpr uint32_t MAX_GENERATION = UINT32_MAX >> CONTROL_TRANSACTION_SLOT_BITS;
+
+ControlTransactions::ControlTransactions(std::shared_ptr<AudioRouter> router, uint64_t timeout_us, uint8_t max_retries) {
+    m_router = std::move(router);
+    m_timeout_us = timeout_us;
+    m_max_retries = max_retries;
+    m_high_water = 0;
+    m_wheel = nullptr;
+    m_update_timer = 0;
+
+    for (auto& slot : m_slots) {
+        slot.generation = 1;
+        slot.kind = SLOT_FREE;
+    }
+}
+
+ControlTransactions::~ControlTransactions() {
+    unschedule();
+
+    // Nobody will answer anymore, do not leave coroutines suspended or futures unset
+    std::vector<Completion> done;
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+        for (size_t i = 0; i < m_high_water; i++) {
+            if (m_slots[i].kind != SLOT_FREE) {
+                done.emplace_back(release((m_slots[i].generation << CONTROL_TRANSACTION_SLOT_BITS) | i, ControlStatus::CANCELLED));
+            }
+        }
+    }
+
+    for (auto& completion : done) {
+        complete(completion);
+    }
+}
+
+void ControlTransactions::schedule_on(TimerWheel &wheel, uint64_t period_us) {
+    unschedule();
+
+    m_wheel = &wheel;
+    m_update_timer = wheel.schedule(period_us, [this]() {
+        update();
+    }, period_us);
+}
+
+void ControlTransactions::unschedule() {
+    if (m_wheel != nullptr) {
+        m_wheel->cancel(m_update_timer);
+        m_wheel = nullptr;
+    }
+}
+
+uint64_t ControlTransactions::make_create_key(uint16_t dest_uid, uint16_t pid, uint8_t seq) {
+    return ((uint64_t)dest_uid << 24) | ((uint64_t)pid << 8) | seq;
+}
+
+ControlTransactions::Slot* ControlTransactions::find_slot(ControlTransactionId id) {
+    Slot& slot = m_slots[id & SLOT_MASK];
+
+    // Answer to a completed transaction whose slot was reused since
+    if (slot.kind == SLOT_FREE || slot.generation != id >> CONTROL_TRANSACTION_SLOT_BITS) {
+        return nullptr;
+    }
+
+    return &slot;
+}
+
+std::optional<ControlTransactionId> ControlTransactions::find_oldest(uint16_t sender_uid, SlotKind kind, uint32_t match) {
+    std::optional<ControlTransactionId> oldest;
+    uint64_t oldest_start = UINT64_MAX;
+
+    // Legacy answers only, a scan of the used slots is fine. Queries match on their type, creations on their pipe
+    for (size_t i = 0; i < m_high_water; i++) {
+        const Slot& slot = m_slots[i];
+        if (slot.kind != kind || slot.dest_uid != sender_uid) {
+            continue;
+        }
+
+        uint32_t slot_match = kind == SLOT_QUERY ? (uint32_t)slot.query.packet_data.qtype : slot.create.packet_data.pid;
+        if (slot_match == match && slot.started < oldest_start) {
+            oldest = (slot.generation << CONTROL_TRANSACTION_SLOT_BITS) | i;
+            oldest_start = slot.started;
+        }
+    }
+
+    return oldest;
+}
+
+std::optional<ControlTransactionId> ControlTransactions::allocate(uint16_t dest_uid, uint64_t timeout_us, int max_retries) {
+    uint16_t index;
+
+    if (!m_free_slots.empty()) {
+        index = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else if (m_high_water < CONTROL_TRANSACTION_CAPACITY) {
+        index = m_high_water++;
+    } else {
+        return {};
+    }
+
+    Slot& slot = m_slots[index];
+    slot.dest_uid = dest_uid;
+    slot.attempts = 1;
+    slot.timeout_us = timeout_us == 0 ? m_timeout_us : timeout_us;
+    slot.max_retries = max_retries < 0 ? m_max_retries : std::min(max_retries, UINT8_MAX - 1);
+    slot.started = oals::tstamp::now_us();
+    slot.deadline = slot.started + slot.timeout_us;
+
+    return (slot.generation << CONTROL_TRANSACTION_SLOT_BITS) | index;
+}
+
+ControlTransactions::Completion ControlTransactions::release(ControlTransactionId id, ControlStatus status) {
+    uint16_t index = id & SLOT_MASK;
+    Slot& slot = m_slots[index];
+
+    Completion completion{};
+    completion.status = status;
+    completion.slot = std::move(slot);
+
+    if (completion.slot.kind == SLOT_CREATE) {
+        const ControlPipeCreate& data = completion.slot.create.packet_data;
+        m_create_index.erase(make_create_key(completion.slot.dest_uid, data.pid, data.seq));
+    }
+
+    // Stale answers carry the previous generation and are dropped by find_slot
+    slot.kind = SLOT_FREE;
+    slot.generation = slot.generation == MAX_GENERATION ? 1 : slot.generation + 1;
+    slot.on_query = nullptr;
+    slot.on_create = nullptr;
+    m_free_slots.push_back(index);
+
+    return completion;
+}
+
+void ControlTransactions::send(const Slot &slot) {
+    if (slot.kind == SLOT_QUERY) {
+        m_router->send_control_packet(slot.query, slot.dest_uid);
+    } else {
+        m_router->send_control_packet(slot.create, slot.dest_uid);
+    }
+}
+
+void ControlTransactions::complete(const Completion &completion) {
+    const Slot& slot = completion.slot;
+
+    if (slot.kind == SLOT_QUERY) {
+        ControlQueryResult result{completion.status, slot.dest_uid, slot.attempts, completion.query_response};
+        if (slot.on_query) {
+            slot.on_query(result);
+        }
+    } else {
+        ControlCreateResult result{completion.status, slot.dest_uid, slot.attempts, completion.create_response};
+        if (slot.on_create) {
+            slot.on_create(result);
+        }
+    }
+}
+
+ControlTransactionId ControlTransactions::query(uint16_t dest_uid, const ControlQuery &query, const std::function<void(const ControlQueryResult &)> &on_complete,
+                                                uint64_t timeout_us, int max_retries) {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+    auto id = allocate(dest_uid, timeout_us, max_retries);
+    if (!id) {
+        return 0;
+    }
+
+    Slot& slot = m_slots[*id & SLOT_MASK];
+    slot.kind = SLOT_QUERY;
+    slot.on_query = on_complete;
+    slot.query.header.type = PacketType::CONTROL_QUERY;
+    slot.query.header.version = OAN_PROTOCOL_VERSION;
+    slot.query.packet_data = query;
+    slot.query.packet_data.transaction_id = *id;
+
+    send(slot);
+    return *id;
+}
+
+ControlTransactionId ControlTransactions::create(uint16_t dest_uid, const ControlPipeCreate &create, const std::function<void(const ControlCreateResult &)> &on_complete,
+                                                 uint64_t timeout_us, int max_retries) {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+    // Answers carry no transaction ID, two pending creations of the same element could not be told apart
+    uint64_t key = make_create_key(dest_uid, create.pid, create.seq);
+    if (m_create_index.contains(key)) {
+        return 0;
+    }
+
+    // Never retransmitted unless asked for, see the class doc
+    auto id = allocate(dest_uid, timeout_us, std::max(max_retries, 0));
+    if (!id) {
+        return 0;
+    }
+
+    Slot& slot = m_slots[*id & SLOT_MASK];
+    slot.kind = SLOT_CREATE;
+    slot.on_create = on_complete;
+    slot.create.header.type = PacketType::CONTROL_CREATE;
+    slot.create.header.version = OAN_PROTOCOL_VERSION;
+    slot.create.packet_data = create;
+    m_create_index[key] = *id;
+
+    send(slot);
+    return *id;
+}
+
+ControlAwaitable<ControlQuery> ControlTransactions::query_async(uint16_t dest_uid, const ControlQuery &query, uint64_t timeout_us, int max_retries) {
+    return ControlAwaitable<ControlQuery>([this, dest_uid, query, timeout_us, max_retries](std::function<void(const ControlQueryResult&)> on_complete) {
+        return this->query(dest_uid, query, on_complete, timeout_us, max_retries);
+    });
+}
+
+ControlAwaitable<ControlResponse> ControlTransactions::create_async(uint16_t dest_uid, const ControlPipeCreate &create, uint64_t timeout_us, int max_retries) {
+    return ControlAwaitable<ControlResponse>([this, dest_uid, create, timeout_us, max_retries](std::function<void(const ControlCreateResult&)> on_complete) {
+        return this->create(dest_uid, create, on_complete, timeout_us, max_retries);
+    });
+}
+
+#ifndef NO_THREADS
+std::future<ControlQueryResult> ControlTransactions::query_future(uint16_t dest_uid, const ControlQuery &query, uint64_t timeout_us, int max_retries) {
+    auto promise = std::make_shared<std::promise<ControlQueryResult>>();
+    auto future = promise->get_future();
+
+    if (this->query(dest_uid, query, [promise](const ControlQueryResult& result) { promise->set_value(result); }, timeout_us, max_retries) == 0) {
+        promise->set_value(ControlQueryResult{ControlStatus::REJECTED, dest_uid, 0, query});
+    }
+
+    return future;
+}
+
+std::future<ControlCreateResult> ControlTransactions::create_future(uint16_t dest_uid, const ControlPipeCreate &create, uint64_t timeout_us, int max_retries) {
+    auto promise = std::make_shared<std::promise<ControlCreateResult>>();
+    auto future = promise->get_future();
+
+    if (this->create(dest_uid, create, [promise](const ControlCreateResult& result) { promise->set_value(result); }, timeout_us, max_retries) == 0) {
+        promise->set_value(ControlCreateResult{ControlStatus::REJECTED, dest_uid, 0, ControlResponse{}});
+    }
+
+    return future;
+}
+#endif // NO_THREADS
+
+bool ControlTransactions::cancel(ControlTransactionId id) {
+    Completion completion;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+        if (find_slot(id) == nullptr) {
+            return false;
+        }
+
+        completion = release(id, ControlStatus::CANCELLED);
+    }
+
+    complete(completion);
+    return true;
+}
+
+bool ControlTransactions::process_query_response(const ControlQueryPacket &pck, const LowLatHeader &llhdr) {
+    Completion completion;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+        ControlTransactionId id = pck.packet_data.transaction_id;
+
+        // Legacy nodes do not echo the transaction ID, the field is not even in their frames
+        if (pck.header.version == 0 || id == 0) {
+            auto legacy = find_oldest(llhdr.sender_uid, SLOT_QUERY, (uint32_t)pck.packet_data.qtype);
+            if (!legacy) {
+                return false;
+            }
+            id = *legacy;
+        }
+
+        Slot* slot = find_slot(id);
+        if (slot == nullptr || slot->kind != SLOT_QUERY || slot->dest_uid != llhdr.sender_uid) {
+            return false;
+        }
+
+        completion = release(id, ControlStatus::OK);
+        completion.query_response = pck.packet_data;
+    }
+
+    complete(completion);
+    return true;
+}
+
+bool ControlTransactions::process_response(const ControlResponsePacket &pck, const LowLatHeader &llhdr) {
+    Completion completion;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+        const ControlResponse& resp = pck.packet_data;
+        std::optional<ControlTransactionId> id;
+
+        if (pck.header.version == 0) {
+            // No seq in legacy answers, nodes handle creations in order
+            id = find_oldest(llhdr.sender_uid, SLOT_CREATE, resp.pid);
+        } else if (auto it = m_create_index.find(make_create_key(llhdr.sender_uid, resp.pid, resp.seq)); it != m_create_index.end()) {
+            id = it->second;
+        }
+
+        if (!id) {
+            return false;
+        }
+
+        completion = release(*id, ControlStatus::OK);
+        completion.create_response = resp;
+    }
+
+    complete(completion);
+    return true;
+}
+
+void ControlTransactions::update() {
+    std::vector<Completion> done;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+        uint64_t now = oals::tstamp::now_us();
+
+        for (size_t i = 0; i < m_high_water; i++) {
+            Slot& slot = m_slots[i];
+            if (slot.kind == SLOT_FREE || now < slot.deadline) {
+                continue;
+            }
+
+            if (slot.attempts > slot.max_retries) {
+                done.emplace_back(release((slot.generation << CONTROL_TRANSACTION_SLOT_BITS) | i, ControlStatus::TIMEOUT));
+                continue;
+            }
+
+            send(slot);
+            slot.attempts++;
+            slot.deadline = now + slot.timeout_us;
+        }
+    }
+
+    for (auto& completion : done) {
+        complete(completion);
+    }
+}
+
+size_t ControlTransactions::pending() {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_transactions_mutex};
+#endif // NO_THREADS
+
+    return m_high_water - m_free_slots.size();
+}
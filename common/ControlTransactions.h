@@ -0,0 +1,273 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef CONTROLTRANSACTIONS_H
+#define CONTROLTRANSACTIONS_H
+
+#ifndef NO_THREADS
+#include <future>
+#include <mutex>
+#endif // NO_THREADS
+
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "AudioRouter.h"
+#include "TimerWheel.h"
+
+#define CONTROL_TRANSACTION_SLOT_BITS 10
+#define CONTROL_TRANSACTION_CAPACITY (1 << CONTROL_TRANSACTION_SLOT_BITS)   /**< Requests in flight at most */
+
+typedef uint32_t ControlTransactionId;     /**< Slot index in the low bits, slot generation above. 0 is never used */
+
+/**
+ * @enum ControlStatus
+ * @brief Outcome of a control request
+ */
+enum class ControlStatus : uint8_t {
+    OK,         /**< The node answered */
+    TIMEOUT,    /**< No answer after every retry */
+    CANCELLED,  /**< Cancelled by the application */
+    REJECTED    /**< Not sent, too many requests in flight */
+};
+
+/**
+ * @struct ControlResult
+ * @brief Completion of a control request
+ * @tparam R Response data type
+ */
+template<class R>
+struct ControlResult {
+    ControlStatus status;   /**< Outcome */
+    uint16_t node_uid;      /**< Node the request was sent to */
+    uint8_t attempts;       /**< Number of times the request was sent */
+    R response;             /**< Node response, valid if status is OK */
+};
+
+typedef ControlResult<ControlQuery> ControlQueryResult;         /**< Completion of a ControlQuery */
+typedef ControlResult<ControlResponse> ControlCreateResult;     /**< Completion of a single ControlPipeCreate */
+
+/**
+ * @class ControlAwaitable
+ * @brief co_await support for control requests. The coroutine resumes on the thread completing the request: the
+ * control receiving thread for an answer, the thread driving update for a timeout.
+ * @tparam R Response data type
+ */
+template<class R>
+class ControlAwaitable {
+public:
+    typedef std::function<ControlTransactionId(std::function<void(const ControlResult<R>&)>)> Starter;
+
+    explicit ControlAwaitable(Starter start) : m_start(std::move(start)), m_result{} {}
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        ControlTransactionId id = m_start([this, handle](const ControlResult<R>& result) {
+            m_result = result;
+            handle.resume();
+        });
+
+        // Not started, the callback will never run: do not suspend
+        if (id == 0) {
+            m_result.status = ControlStatus::REJECTED;
+            return false;
+        }
+
+        return true;
+    }
+
+    ControlResult<R> await_resume() {
+        return m_result;
+    }
+
+private:
+    Starter m_start;
+    ControlResult<R> m_result;
+};
+
+/**
+ * @class ControlTransactions
+ * @brief Request/response layer over the control plane. Each ControlQuery or ControlPipeCreate gets a transaction,
+ * retransmitted until the node answers, the retries are exhausted or the application cancels it. Completion is
+ * delivered through a callback, a coroutine awaitable or, with threads, a future.
+ *
+ * Transactions live in a fixed slot table. Queries carry the transaction ID, which nodes must echo unchanged in their
+ * answer: it leads straight to the slot. Legacy nodes (protocol version 0) do not echo it, their answers complete the
+ * oldest pending query of the same type to that node, nodes answer in order. Pipe creation answers (ControlResponse)
+ * are matched on (node, pid, seq) instead, or on the oldest pending creation of the pipe for legacy nodes which do
+ * not send seq back. Stale answers to reused slots are told apart by the generation held in the ID.
+ *
+ * Queries are retransmitted by default, they have no side effect. Creations are not: a node which does not
+ * deduplicate on (pid, seq) creates the element again when a retransmission crosses a lost answer, so creations are
+ * only retransmitted when max_retries is given explicitly, for nodes known to deduplicate.
+ *
+ * Like PipeTransactionEngine, the application forwards the answers (process_query_response, process_response) and
+ * drives timeouts with update or schedule_on. Callbacks run without the internal lock held.
+ */
+class ControlTransactions {
+public:
+    /**
+     * Constructor
+     * @param router Router used to send the requests
+     * @param timeout_us Default time to wait for an answer before sending the request again
+     * @param max_retries Default number of query retransmissions before a query times out
+     */
+    ControlTransactions(std::shared_ptr<AudioRouter> router, uint64_t timeout_us = 20000, uint8_t max_retries = 3);
+    ~ControlTransactions();
+
+    /**
+     * Send a query
+     * @param dest_uid Node to query
+     * @param query Query, its transaction_id is overwritten
+     * @param on_complete Called once with the answer or the failure
+     * @param timeout_us Time to wait for an answer, 0 for the default
+     * @param max_retries Retransmissions, -1 for the default
+     * @return Transaction ID, 0 if too many requests are in flight
+     */
+    ControlTransactionId query(uint16_t dest_uid, const ControlQuery& query, const std::function<void(const ControlQueryResult&)>& on_complete,
+                               uint64_t timeout_us = 0, int max_retries = -1);
+
+    /**
+     * Send a single pipe element creation. Use PipeTransactionEngine to create whole pipes.
+     * @param dest_uid Node to create the element on
+     * @param create Creation packet data
+     * @param on_complete Called once with the answer or the failure
+     * @param timeout_us Time to wait for an answer, 0 for the default
+     * @param max_retries Retransmissions, -1 for none. Only for nodes deduplicating creations, see the class doc
+     * @return Transaction ID, 0 if too many requests are in flight or the same element is already pending
+     */
+    ControlTransactionId create(uint16_t dest_uid, const ControlPipeCreate& create, const std::function<void(const ControlCreateResult&)>& on_complete,
+                                uint64_t timeout_us = 0, int max_retries = -1);
+
+    /**
+     * co_await friendly query
+     */
+    ControlAwaitable<ControlQuery> query_async(uint16_t dest_uid, const ControlQuery& query, uint64_t timeout_us = 0, int max_retries = -1);
+
+    /**
+     * co_await friendly pipe element creation
+     */
+    ControlAwaitable<ControlResponse> create_async(uint16_t dest_uid, const ControlPipeCreate& create, uint64_t timeout_us = 0, int max_retries = -1);
+
+#ifndef NO_THREADS
+    /**
+     * Query returning a future. Never wait on it from the thread forwarding the answers.
+     */
+    std::future<ControlQueryResult> query_future(uint16_t dest_uid, const ControlQuery& query, uint64_t timeout_us = 0, int max_retries = -1);
+
+    /**
+     * Pipe element creation returning a future. Never wait on it from the thread forwarding the answers.
+     */
+    std::future<ControlCreateResult> create_future(uint16_t dest_uid, const ControlPipeCreate& create, uint64_t timeout_us = 0, int max_retries = -1);
+#endif // NO_THREADS
+
+    /**
+     * Cancel a pending request, its completion runs with ControlStatus::CANCELLED
+     * @param id Transaction ID
+     * @return false if the request already completed
+     */
+    bool cancel(ControlTransactionId id);
+
+    /**
+     * Feed a query answer. Answers without transaction ID complete the oldest matching query, see the class doc.
+     * @return true if it completed a pending query
+     */
+    bool process_query_response(const ControlQueryPacket& pck, const LowLatHeader& llhdr);
+
+    /**
+     * Feed a pipe creation answer
+     * @return true if it completed a pending creation
+     */
+    bool process_response(const ControlResponsePacket& pck, const LowLatHeader& llhdr);
+
+    /**
+     * Retransmit or time out the requests whose deadline passed
+     */
+    void update();
+
+    /**
+     * @return Number of pending requests
+     */
+    size_t pending();
+
+    /**
+     * Drive update from a timer wheel
+     * @param wheel Timer wheel, must outlive the transactions or unschedule must be called first
+     * @param period_us Update period, bounds the timeout accuracy
+     */
+    void schedule_on(TimerWheel& wheel, uint64_t period_us = 5000);
+
+    /**
+     * Cancel the timer installed by schedule_on. Called by the destructor.
+     */
+    void unschedule();
+
+private:
+    enum SlotKind : uint8_t {
+        SLOT_FREE,
+        SLOT_QUERY,
+        SLOT_CREATE
+    };
+
+    struct Slot {
+        uint32_t generation;
+        SlotKind kind;
+        uint16_t dest_uid;
+        uint8_t attempts;
+        uint8_t max_retries;
+        uint64_t timeout_us;
+        uint64_t started;
+        uint64_t deadline;
+        ControlQueryPacket query;
+        ControlPipeCreatePacket create;
+        std::function<void(const ControlQueryResult&)> on_query;
+        std::function<void(const ControlCreateResult&)> on_create;
+    };
+
+    struct Completion {
+        ControlStatus status;
+        Slot slot;
+        ControlQuery query_response;
+        ControlResponse create_response;
+    };
+
+    static uint64_t make_create_key(uint16_t dest_uid, uint16_t pid, uint8_t seq);
+
+    Slot* find_slot(ControlTransactionId id);
+    std::optional<ControlTransactionId> find_oldest(uint16_t sender_uid, SlotKind kind, uint32_t match);
+    std::optional<ControlTransactionId> allocate(uint16_t dest_uid, uint64_t timeout_us, int max_retries);
+    Completion release(ControlTransactionId id, ControlStatus status);
+    void send(const Slot& slot);
+    static void complete(const Completion& completion);
+
+    std::shared_ptr<AudioRouter> m_router;
+    uint64_t m_timeout_us;
+    uint8_t m_max_retries;
+
+    std::array<Slot, CONTROL_TRANSACTION_CAPACITY> m_slots;
+    std::vector<uint16_t> m_free_slots;
+    size_t m_high_water;    // Slots above were never used, update does not scan them
+    std::unordered_map<uint64_t, ControlTransactionId> m_create_index;     // (node, pid, seq) -> transaction
+
+    TimerWheel* m_wheel;
+    TimerId m_update_timer;
+
+#ifndef NO_THREADS
+    std::mutex m_transactions_mutex;
+#endif // NO_THREADS
+};
+
+
+
+#endif //CONTROLTRANSACTIONS_H
@@ -0,0 +1,92 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "FailureDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+FailureDetector::FailureDetector(double phi_threshold, uint64_t min_std_dev_us, uint64_t acceptable_pause_us) {
+    m_phi_threshold = phi_threshold;
+    m_min_std_dev_us = (double)min_std_dev_us;
+    m_acceptable_pause_us = (double)acceptable_pause_us;
+    reset();
+}
+
+void FailureDetector::heartbeat(uint64_t now_us, uint64_t expected_interval_us) {
+    if (m_last_arrival == 0 || expected_interval_us != m_expected_interval_us) {
+        // Bootstrap with the advertised interval and a pessimistic deviation, refined by the real arrivals.
+        // Arrivals learnt under another interval would make the next gap look like a failure.
+        reset();
+        m_expected_interval_us = expected_interval_us;
+
+        double interval = (double)expected_interval_us;
+        double dev = interval / 4.0;
+        push_interval(interval - dev);
+        push_interval(interval + dev);
+    } else if (now_us > m_last_arrival) {
+        push_interval((double)(now_us - m_last_arrival));
+    }
+
+    m_last_arrival = now_us;
+}
+
+double FailureDetector::phi(uint64_t now_us) const {
+    if (m_last_arrival == 0 || m_count == 0 || now_us <= m_last_arrival) {
+        return 0.0;
+    }
+
+    double mean = m_sum / (double)m_count;
+    double variance = std::max(0.0, m_sum_sq / (double)m_count - mean * mean);
+    double std_dev = std::max(std::sqrt(variance), m_min_std_dev_us);
+
+    // Logistic approximation of the normal CDF tail, stays finite far in the tail
+    double elapsed = (double)(now_us - m_last_arrival);
+    double y = (elapsed - (mean + m_acceptable_pause_us)) / std_dev;
+    double e = std::exp(-y * (1.5976 + 0.070566 * y * y));
+
+    if (elapsed > mean + m_acceptable_pause_us) {
+        return -std::log10(e / (1.0 + e));
+    }
+
+    return -std::log10(1.0 - 1.0 / (1.0 + e));
+}
+
+bool FailureDetector::suspected(uint64_t now_us) const {
+    return phi(now_us) > m_phi_threshold;
+}
+
+bool FailureDetector::has_heartbeats() const {
+    return m_last_arrival != 0;
+}
+
+void FailureDetector::reset() {
+    m_intervals.fill(0.0);
+    m_count = 0;
+    m_next = 0;
+    m_sum = 0.0;
+    m_sum_sq = 0.0;
+    m_last_arrival = 0;
+    m_expected_interval_us = 0;
+}
+
+void FailureDetector::set_phi_threshold(double phi_threshold) {
+    m_phi_threshold = phi_threshold;
+}
+
+void FailureDetector::push_interval(double interval_us) {
+    if (m_count == FAILURE_DETECTOR_WINDOW) {
+        double old = m_intervals[m_next];
+        m_sum -= old;
+        m_sum_sq -= old * old;
+    } else {
+        m_count++;
+    }
+
+    m_intervals[m_next] = interval_us;
+    m_sum += interval_us;
+    m_sum_sq += interval_us * interval_us;
+    m_next = (m_next + 1) % FAILURE_DETECTOR_WINDOW;
+}
@@ -0,0 +1,85 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef FAILUREDETECTOR_H
+#define FAILUREDETECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef FAILURE_DETECTOR_WINDOW
+#define FAILURE_DETECTOR_WINDOW 32     /**< Heartbeat intervals learnt, 8 bytes each */
+#endif // FAILURE_DETECTOR_WINDOW
+
+/**
+ * @class FailureDetector
+ * @brief Phi accrual failure detector for one peer. Learns the heartbeat inter-arrival distribution over the last
+ * FAILURE_DETECTOR_WINDOW heartbeats and gives the suspicion level phi = -log10(P(no heartbeat yet | peer alive)).
+ * The peer is considered dead once phi crosses the threshold, which adapts the timeout to the observed jitter.
+ */
+class FailureDetector {
+public:
+    /**
+     * Constructor
+     * @param phi_threshold Suspicion level above which the peer is dead. 8 means a 1e-8 false positive probability
+     * @param min_std_dev_us Lower bound of the inter-arrival standard deviation, avoids over-confidence on quiet links
+     * @param acceptable_pause_us Extra delay tolerated on top of the learnt mean, absorbs scheduling stalls under load
+     */
+    FailureDetector(double phi_threshold = 8.0, uint64_t min_std_dev_us = 10000, uint64_t acceptable_pause_us = 100000);
+    ~FailureDetector() = default;
+
+    /**
+     * Record a heartbeat arrival. The first heartbeat seeds the window from the interval the peer advertises, and
+     * seeds it again when the peer advertises another interval.
+     * @param now_us Arrival time, local monotonic us
+     * @param expected_interval_us Heartbeat interval advertised by the peer
+     */
+    void heartbeat(uint64_t now_us, uint64_t expected_interval_us);
+
+    /**
+     * Current suspicion level
+     * @param now_us Local monotonic time in us
+     * @return phi, 0 if no heartbeat was received yet
+     */
+    double phi(uint64_t now_us) const;
+
+    /**
+     * @param now_us Local monotonic time in us
+     * @return true if phi is above the threshold
+     */
+    bool suspected(uint64_t now_us) const;
+
+    /**
+     * @return true once a heartbeat was received. Peers that never send heartbeats must be handled by the caller
+     */
+    bool has_heartbeats() const;
+
+    /**
+     * Forget the learnt distribution, for a new or restarted peer
+     */
+    void reset();
+
+    void set_phi_threshold(double phi_threshold);
+
+private:
+    void push_interval(double interval_us);
+
+    double m_phi_threshold;
+    double m_min_std_dev_us;
+    double m_acceptable_pause_us;
+
+    std::array<double, FAILURE_DETECTOR_WINDOW> m_intervals;
+    size_t m_count;
+    size_t m_next;
+    double m_sum;
+    double m_sum_sq;
+    uint64_t m_last_arrival;
+    uint64_t m_expected_interval_us;
+};
+
+
+
+#endif //FAILUREDETECTOR_H
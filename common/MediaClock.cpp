@@ -0,0 +1,66 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "MediaClock.h"
+
+#include "ClockSlave.h"
+
+MediaClock::MediaClock(SamplingRate rate, std::shared_ptr<ClockSlave> clock, uint32_t latency_samples) {
+    m_clock = std::move(clock);
+    m_rate = rate;
+    m_rate_hz = sample_rate_hz(rate);
+    m_latency_samples = latency_samples;
+}
+
+uint64_t MediaClock::now_network_us() const {
+    if (m_clock) {
+        return m_clock->now_network_us();
+    }
+
+    return oals::tstamp::now_epoch_us();
+}
+
+uint64_t MediaClock::now_samples() const {
+    // The sample playing now started at or before now
+    uint64_t now = now_network_us();
+    uint64_t sample = network_us_to_sample(now);
+
+    return sample_to_network_us(sample) > now ? sample - 1 : sample;
+}
+
+uint64_t MediaClock::sample_to_network_us(uint64_t sample) const {
+    // Split to avoid overflowing on epoch based times
+    uint64_t seconds = sample / m_rate_hz;
+    uint64_t rem = sample % m_rate_hz;
+
+    return seconds * 1000000 + (rem * 1000000) / m_rate_hz;
+}
+
+uint64_t MediaClock::network_us_to_sample(uint64_t network_us) const {
+    uint64_t seconds = network_us / 1000000;
+    uint64_t rem = network_us % 1000000;
+
+    return seconds * m_rate_hz + (rem * m_rate_hz + 999999) / 1000000;
+}
+
+void MediaClock::stamp(AudioPacket &packet, uint64_t capture_sample) const {
+    packet.header.timestamp = sample_to_network_us(capture_sample + m_latency_samples);
+}
+
+uint64_t MediaClock::presentation_sample(const AudioPacket &packet) const {
+    return network_us_to_sample(packet.header.timestamp);
+}
+
+int64_t MediaClock::samples_until_presentation(const AudioPacket &packet) const {
+    return (int64_t)(presentation_sample(packet) - now_samples());
+}
+
+SamplingRate MediaClock::get_sample_rate() const {
+    return m_rate;
+}
+
+uint32_t MediaClock::get_latency_samples() const {
+    return m_latency_samples;
+}
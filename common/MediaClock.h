@@ -0,0 +1,98 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef MEDIACLOCK_H
+#define MEDIACLOCK_H
+
+#include <cstdint>
+#include <memory>
+
+#include "audio_conf.h"
+#include "packet_structs.h"
+
+class ClockSlave;
+
+/**
+ * @class MediaClock
+ * @brief Maps sample indices to network time. Sample n of the network plays at floor(n * 1e6 / rate) us of network
+ * time, so every node sharing the network time agrees on the position of each sample without exchanging it.
+ *
+ * The conversion round trips exactly : network_us_to_sample(sample_to_network_us(n)) == n, since a sample period is
+ * longer than 1 us at every supported rate.
+ */
+class MediaClock {
+public:
+    /**
+     * Constructor
+     * @param rate Sampling rate of the stream
+     * @param clock Synchronized clock. If null, the local time since the Unix epoch is the network time (single clock
+     * master, a master with standbys follows ClockMaster::now_network_us instead)
+     * @param latency_samples Delay between capture and presentation, in samples
+     */
+    MediaClock(SamplingRate rate, std::shared_ptr<ClockSlave> clock, uint32_t latency_samples = 2 * AUDIO_DATA_SAMPLES_PER_PACKETS);
+    ~MediaClock() = default;
+
+    /**
+     * @param rate Sampling rate
+     * @return Rate in Hz
+     */
+    static constexpr uint32_t sample_rate_hz(SamplingRate rate) {
+        return rate == SamplingRate::SAMPLING_96K ? 96000 : 48000;
+    }
+
+    /**
+     * @return Current network time in us
+     */
+    uint64_t now_network_us() const;
+
+    /**
+     * @return Index of the sample playing now
+     */
+    uint64_t now_samples() const;
+
+    /**
+     * @param sample Sample index
+     * @return Network time at which the sample plays, in us
+     */
+    uint64_t sample_to_network_us(uint64_t sample) const;
+
+    /**
+     * @param network_us Network time in us
+     * @return First sample playing at or after the given time
+     */
+    uint64_t network_us_to_sample(uint64_t network_us) const;
+
+    /**
+     * Stamp an audio packet with the presentation time of its first sample
+     * @param packet Packet to stamp
+     * @param capture_sample Index of the first sample of the packet, as captured
+     */
+    void stamp(AudioPacket& packet, uint64_t capture_sample) const;
+
+    /**
+     * @param packet Stamped packet
+     * @return Index of the packet first sample in the presentation timeline
+     */
+    uint64_t presentation_sample(const AudioPacket& packet) const;
+
+    /**
+     * @param packet Stamped packet
+     * @return Samples left before the packet must be played, negative if already late
+     */
+    int64_t samples_until_presentation(const AudioPacket& packet) const;
+
+    SamplingRate get_sample_rate() const;
+    uint32_t get_latency_samples() const;
+
+private:
+    std::shared_ptr<ClockSlave> m_clock;
+    SamplingRate m_rate;
+    uint32_t m_rate_hz;
+    uint32_t m_latency_samples;
+};
+
+
+
+#endif //MEDIACLOCK_H
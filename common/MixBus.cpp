@@ -0,0 +1,143 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "MixBus.h"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIXBUS_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static void mix_accumulate_scalar(float* dst, const float* src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] += src[i];
+    }
+}
+
+#ifdef MIXBUS_X86
+__attribute__((target("avx2")))
+static void mix_accumulate_avx2(float* dst, const float* src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 acc = _mm256_load_ps(dst + i);
+        acc = _mm256_add_ps(acc, _mm256_loadu_ps(src + i));
+        _mm256_store_ps(dst + i, acc);
+    }
+
+    mix_accumulate_scalar(dst + i, src + i, n - i);
+}
+#endif // MIXBUS_X86
+
+void mix_accumulate(float* dst, const float* src, size_t n) {
+#ifdef MIXBUS_X86
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        mix_accumulate_avx2(dst, src, n);
+        return;
+    }
+
+    mix_accumulate_scalar(dst, src, n);
+#elif defined(__ARM_NEON)
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+    }
+
+    mix_accumulate_scalar(dst + i, src + i, n - i);
+#else
+    mix_accumulate_scalar(dst, src, n);
+#endif
+}
+
+MixBus::MixBus() {
+    m_bus_index.fill(-1);
+    m_block_callback = [](MixBusBlock&) {};
+}
+
+void MixBus::add_source(uint8_t channel, uint8_t source_channel) {
+    if (m_bus_index[channel] < 0) {
+        Bus bus{};
+        bus.block.channel = channel;
+
+        m_bus_index[channel] = m_buses.size();
+        m_buses.emplace_back(bus);
+    }
+
+    Bus& bus = m_buses[m_bus_index[channel]];
+    bus.expected[source_channel / 64] |= 1ULL << (source_channel % 64);
+
+    bus.expected_count = 0;
+    for (auto word : bus.expected) {
+        bus.expected_count += std::popcount(word);
+    }
+}
+
+void MixBus::accumulate(const AudioPacket &packet) {
+    int16_t idx = m_bus_index[packet.packet_data.channel];
+    if (idx < 0) {
+        return;
+    }
+
+    Bus& bus = m_buses[idx];
+    uint64_t timestamp = packet.header.timestamp;
+
+    // Late contribution to an already emitted period, or older than the block being summed
+    if ((bus.emitted && timestamp <= bus.last_emitted) || (bus.pending && timestamp < bus.block.timestamp)) {
+        return;
+    }
+
+    if (bus.pending && timestamp > bus.block.timestamp) {
+        emit(bus);
+    }
+
+    uint8_t src = packet.packet_data.source_channel;
+    uint64_t src_bit = 1ULL << (src % 64);
+
+    // Unknown source or duplicate
+    if (!(bus.expected[src / 64] & src_bit) || (bus.received[src / 64] & src_bit)) {
+        return;
+    }
+
+    if (!bus.pending) {
+        std::fill(std::begin(bus.block.samples), std::end(bus.block.samples), 0.0f);
+        bus.block.timestamp = timestamp;
+        bus.block.source_count = 0;
+        bus.pending = true;
+    }
+
+    mix_accumulate(bus.block.samples, packet.packet_data.samples, AUDIO_DATA_SAMPLES_PER_PACKETS);
+    bus.received[src / 64] |= src_bit;
+    bus.block.source_count++;
+
+    if (bus.block.source_count == bus.expected_count) {
+        emit(bus);
+    }
+}
+
+void MixBus::flush() {
+    for (auto& bus : m_buses) {
+        if (bus.pending) {
+            emit(bus);
+        }
+    }
+}
+
+void MixBus::set_block_callback(const std::function<void(MixBusBlock &)> &callback) {
+    m_block_callback = callback;
+}
+
+void MixBus::emit(Bus &bus) {
+    m_block_callback(bus.block);
+
+    bus.last_emitted = bus.block.timestamp;
+    bus.emitted = true;
+    bus.received.fill(0);
+    bus.pending = false;
+}
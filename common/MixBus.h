@@ -0,0 +1,98 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef MIXBUS_H
+#define MIXBUS_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "packet_structs.h"
+
+/**
+ * @struct MixBusBlock
+ * @brief Summed samples of every source feeding a destination channel for one period
+ */
+struct MixBusBlock {
+    alignas(32) float samples[AUDIO_DATA_SAMPLES_PER_PACKETS];  /**< Summed samples */
+    uint64_t timestamp;                                         /**< Timestamp of the summed packets */
+    uint8_t channel;                                            /**< Destination channel */
+    uint16_t source_count;                                      /**< Sources summed in this block */
+};
+
+/**
+ * Adds n samples of src to dst. dst must be 32 bytes aligned, src may be unaligned.
+ * Dispatches to AVX2 or NEON when available.
+ */
+void mix_accumulate(float* dst, const float* src, size_t n);
+
+/**
+ * @class MixBus
+ * @brief Receive side summing of several AudioData sources (source_channel) into one destination channel.
+ * A block is emitted as soon as every declared source contributed for a timestamp, or when a newer timestamp
+ * shows up while the block is still partial. Contributions older than the pending block, or to a period already
+ * emitted, are dropped: each period reaches the callback at most once.
+ */
+class MixBus {
+public:
+    MixBus();
+    ~MixBus() = default;
+
+    /**
+     * Declare a source feeding a destination channel
+     * @param channel Destination channel
+     * @param source_channel Source channel
+     */
+    void add_source(uint8_t channel, uint8_t source_channel);
+
+    /**
+     * @param channel Destination channel
+     * @return true if the channel is summed by this bus
+     */
+    bool handles(uint8_t channel) const {
+        return m_bus_index[channel] >= 0;
+    }
+
+    /**
+     * Sum a received packet in its destination bus
+     * @param packet Received audio packet, packet_data.channel is the destination
+     */
+    void accumulate(const AudioPacket& packet);
+
+    /**
+     * Emit every partial block
+     */
+    void flush();
+
+    /**
+     * Install the callback called for each summed block
+     * @param callback Summed block handler. The block is only valid during the call
+     */
+    void set_block_callback(const std::function<void(MixBusBlock&)>& callback);
+
+private:
+    struct Bus {
+        MixBusBlock block;
+        std::array<uint64_t, 4> expected;
+        std::array<uint64_t, 4> received;
+        uint16_t expected_count;
+        uint64_t last_emitted;
+        bool emitted;       // last_emitted is valid, timestamp 0 is a legitimate period
+        bool pending;
+    };
+
+    void emit(Bus& bus);
+
+    std::array<int16_t, 256> m_bus_index;
+    std::vector<Bus> m_buses;
+
+    std::function<void(MixBusBlock&)> m_block_callback;
+};
+
+
+
+#endif //MIXBUS_H
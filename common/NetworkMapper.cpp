@@ -7,27 +7,66 @@
 
 #ifndef __linux__
 extern void _delay(uint32_t ms);
-extern uint32_t _now_ms();
-extern uint64_t _now_us();
 extern "C" IfaceMeta _fetch_iface_meta(const std::string&);
 #endif // __linux__
 
 NetworkMapper::NetworkMapper(const PeerConf& pconf) {
-    m_peer_change_callback = [](PeerInfos&, bool) {};
+    m_peer_event_callback = [](PeerInfos&, bool) {};
+    m_heartbeat_interval_ms = 50;
+    m_announce_interval_ms = 5000;
+    m_next_announce = 0;
+    m_next_heartbeat = 0;
+    m_last_resync = 0;
+    m_rx_budget = MAPPER_RX_BUDGET;
+    m_view_digest = 0;
+    m_last_delta = 0;
+    m_delta_repeats = 0;
+    m_wheel = nullptr;
+    m_send_timer = 0;
+    m_liveness_timer = 0;
+#ifndef NO_THREADS
+    m_running = false;
+#endif // NO_THREADS
     update_packet(pconf);
 }
 
 NetworkMapper::~NetworkMapper() {
-
+    stop_mapping_process();
 }
 
-bool NetworkMapper::init_mapper(const std::string& iface) {
+bool NetworkMapper::init_mapper(const std::string& iface, const std::string& peer_cache_path) {
     m_map_socket = std::make_unique<LowLatSocket>(m_packet.packet_data.self_uid, std::shared_ptr<NetworkMapper>{});
     bool res = m_map_socket->init_socket(iface, EthProtocol::ETH_PROTO_OANDISCO);
 
+    if (res && !peer_cache_path.empty() && m_cache.open(peer_cache_path)) {
+        load_peer_cache();
+    }
+
     return res;
 }
 
+void NetworkMapper::load_peer_cache() {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+    uint64_t now = oals::tstamp::now_ms();
+
+    // Cache slots follow the peer store slots, which are reassigned on load
+    auto entries = m_cache.load(PEER_CACHE_MAX_AGE_MS);
+    m_cache.clear();
+
+    for (auto& entry : entries) {
+        if (entry.data.self_uid == m_packet.packet_data.self_uid || m_peers.find(entry.data.self_uid).has_value()) {
+            continue;
+        }
+
+        auto slot = m_peers.upsert(entry.data, now, PEER_SLOT_PROVISIONAL);
+        if (slot.has_value()) {
+            m_cache.store(slot.value(), entry.data, entry.last_seen);
+        }
+    }
+}
+
 void NetworkMapper::update_packet(const PeerConf &pconf) {
 #ifdef __linux__
     auto iface_meta = get_iface_meta(pconf.iface);
@@ -36,6 +75,7 @@ void NetworkMapper::update_packet(const PeerConf &pconf) {
 #endif // __linux__
 
     m_packet.header.type = PacketType::MAPPING;
+    m_packet.header.version = OAN_PROTOCOL_VERSION;
     m_packet.packet_data.topo = pconf.topo;
 
     m_packet.packet_data.self_uid = pconf.uid;
@@ -48,228 +88,499 @@ void NetworkMapper::update_packet(const PeerConf &pconf) {
     memcpy(&m_packet.packet_data.self_address, iface_meta.mac, 6);
 
     memcpy(&m_packet.packet_data.dev_name, pconf.dev_name, 32);
+    m_packet.packet_data.generation = 0;
+
+    m_heartbeat = {};
+    m_heartbeat.header.type = PacketType::HEARTBEAT;
+    m_heartbeat.header.version = OAN_PROTOCOL_VERSION;
+    m_heartbeat.packet_data.self_uid = pconf.uid;
+    m_heartbeat.packet_data.seq = 0;
+    m_heartbeat.packet_data.interval_ms = m_heartbeat_interval_ms;
+
+    // Nodes powered on together must not announce in phase
+    m_rng.seed(((uint64_t)pconf.uid << 32) ^ oals::tstamp::now_ns());
+}
+
+void NetworkMapper::configure_liveness(uint16_t heartbeat_interval_ms, uint32_t announce_interval_ms, double phi_threshold) {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+    m_heartbeat_interval_ms = std::max<uint16_t>(heartbeat_interval_ms, 1);
+    m_announce_interval_ms = announce_interval_ms;
+    m_heartbeat.packet_data.interval_ms = m_heartbeat_interval_ms;
+
+    for (auto& detector : m_liveness) {
+        detector.set_phi_threshold(phi_threshold);
+    }
+}
+
+void NetworkMapper::schedule_on(TimerWheel &wheel) {
+    if (m_wheel != nullptr) {
+        m_wheel->cancel(m_send_timer);
+        m_wheel->cancel(m_liveness_timer);
+    }
+
+    m_wheel = &wheel;
+    uint64_t interval_us = (uint64_t)m_heartbeat_interval_ms * 1000;
+
+    m_send_timer = wheel.schedule(0, [this]() {
+        packet_send_update();
+    }, interval_us);
+
+    m_liveness_timer = wheel.schedule(interval_us, [this]() {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+        mapper_update();
+    }, interval_us);
 }
 
 void NetworkMapper::launch_mapping_process() {
 #ifndef NO_THREADS
-    // Mapper sending thread
-    m_tx_thread = std::thread([this]() {
-        packet_sender();
-    });
-    m_tx_thread.detach();
+    stop_mapping_process();
+
+    m_own_wheel = std::make_unique<TimerWheel>();
+    launch_mapping_process(*m_own_wheel);
+    m_own_wheel->launch();
+#endif // NO_THREADS
+}
+
+void NetworkMapper::launch_mapping_process(TimerWheel &wheel) {
+    schedule_on(wheel);
 
-    // Mapper receiving thread
+#ifndef NO_THREADS
+    if (m_rx_thread.joinable()) {
+        return;
+    }
+
+    // Bounded receive so that the thread notices shutdown
+    m_map_socket->set_receive_timeout(100000);
+
+    m_running = true;
     m_rx_thread = std::thread([this]() {
         packet_receiver();
     });
-    m_rx_thread.detach();
+#endif // NO_THREADS
+}
 
-    m_mapper_thread = std::thread([this]() {
-        mapper_process();
-    });
-    m_mapper_thread.detach();
+void NetworkMapper::stop_mapping_process() {
+    // Waits for a running timer callback, must not be called with the mapper mutex held
+    if (m_wheel != nullptr) {
+        m_wheel->cancel(m_send_timer);
+        m_wheel->cancel(m_liveness_timer);
+        m_wheel = nullptr;
+    }
+
+#ifndef NO_THREADS
+    m_running = false;
+    if (m_rx_thread.joinable()) {
+        m_rx_thread.join();
+    }
+
+    if (m_own_wheel) {
+        m_own_wheel->stop();
+        m_own_wheel.reset();
+    }
 #endif // NO_THREADS
 }
 
 void NetworkMapper::mapper_update() {
-    uint64_t now = local_now();
+    uint64_t now = oals::tstamp::now_ms();
+    uint64_t now_us = oals::tstamp::now_us();
     constexpr int die_timeout = 15000;
 
-    std::erase_if(m_peers, [now, this](const std::pair<int, PeerInfos> &pred) {
-        uint64_t delta = now - pred.second.alive_stamp;
-        if (delta > die_timeout) {
-            PeerInfos pinfo = pred.second;
+    // Called with the mapper mutex held
+    m_rx_budget = MAPPER_RX_BUDGET;
 
-#ifdef __linux__
-            std::cout << "Lost " << pinfo.peer_data.dev_name << " (ID = " << pinfo.peer_data.self_uid << ")" << std::endl;
-#endif // __linux__
+    m_peers.expire_temp(now, PEER_TEMP_TTL_MS);
+
+    for (size_t slot = 0; slot < m_peers.high_water(); slot++) {
+        const PeerHot& hot = m_peers.hot(slot);
+
+        // Cached peers that did not show up within two announcements are gone
+        if (hot.state == PEER_SLOT_PROVISIONAL && now - hot.alive_stamp > 2 * (uint64_t)m_announce_interval_ms) {
+            m_cache.erase(slot);
+            m_peers.remove(hot.uid);
+            continue;
+        }
+
+        if (hot.state != PEER_SLOT_KNOWN) {
+            continue;
+        }
+
+        // Peers sending heartbeats are judged by their failure detector, older ones by the announcement timeout
+        bool dead;
+        if (m_liveness[slot].has_heartbeats()) {
+            dead = m_liveness[slot].suspected(now_us);
+        } else {
+            dead = now - hot.alive_stamp > die_timeout;
+        }
+
+        if (dead) {
+            PeerInfos pinfo = peer_infos(slot);
 
-            std::erase_if(m_ck_slaves, [this, pred](const PeerInfos& pi) {
-                return pi.peer_data.self_uid == pred.second.peer_data.self_uid;
+            std::erase_if(m_ck_slaves, [&pinfo](const PeerInfos& pi) {
+                return pi.peer_data.self_uid == pinfo.peer_data.self_uid;
             });
 
-            m_peer_change_callback(pinfo, false);
+            m_view_digest ^= peer_digest(pinfo.peer_data.self_uid, pinfo.peer_data.generation);
+            m_cache.erase(slot);
+            m_peers.remove(pinfo.peer_data.self_uid);
+            m_placer.remove_dsp(pinfo.peer_data.self_uid);
 
-            return true;
+            m_changed_peers.push_back(pinfo.peer_data.self_uid);
         }
+    }
 
-        return false;
-    });
+    publish_peer_changes();
 }
 
 void NetworkMapper::packet_recv_update() {
-    LowLatPacket<MappingPacket> pck{};
-    int rx_data = m_map_socket->receive_data(&pck, false);
+    alignas(std::max_align_t) uint8_t raw_packet_buffer[sizeof(LowLatPacket<MappingPacket>)];
+    int rx_data = m_map_socket->receive_data_raw(reinterpret_cast<char*>(raw_packet_buffer), sizeof(raw_packet_buffer), false);
 
-    if(rx_data > 0 && pck.payload.header.type == PacketType::MAPPING) {
-        process_packet(pck.payload);
+    if (rx_data <= 0) {
+        return;
     }
-}
 
-void NetworkMapper::packet_send_update() {
-    m_map_socket->send_data<MappingPacket>(m_packet, 0);
+    process_frame(raw_packet_buffer, (size_t)rx_data);
 }
 
-void NetworkMapper::packet_sender() {
-    while(true) {
-        packet_send_update();
-#ifdef __linux__
-        usleep(5000000);
-#else
+void NetworkMapper::process_frame(uint8_t *buffer, size_t size) {
+    FrameView frame{buffer, size};
+    if (!frame.valid()) {
+        return;
+    }
 
-#endif // __linux__
+    switch (frame.header().type) {
+        case PacketType::MAPPING: {
+            // MappingData holds 64 bits fields which would be misaligned in the frame, copy it out.
+            // Legacy announcements have no generation, it is left at 0
+            if (frame.llhdr().psize >= packet_min_size<MappingData>(frame.header().version)) {
+                MappingPacket pck;
+                memset(&pck, 0, sizeof(pck));
+                memcpy(&pck, &frame.header(), std::min<size_t>(frame.llhdr().psize, sizeof(MappingPacket)));
+                process_packet(pck);
+            }
+            break;
+        }
+
+        case PacketType::MAPPING_DELTA: {
+            auto view = frame.as<MappingDelta>();
+            if (view.valid()) {
+                process_delta(view.packet().packet_data);
+            }
+            break;
+        }
+
+        case PacketType::HEARTBEAT: {
+            auto view = frame.as<Heartbeat>();
+            if (view.valid()) {
+                process_heartbeat(view.packet().packet_data);
+            }
+            break;
+        }
+
+        default:
+            break;
     }
 }
 
-void NetworkMapper::packet_receiver() {
-    while(true) {
-        packet_recv_update();
+void NetworkMapper::packet_send_update() {
+    uint64_t now = oals::tstamp::now_ms();
+
+    // Deltas that were rate limited or still have to be repeated
+    send_pending_delta();
+
+    HeartbeatPacket heartbeat;
+    bool heartbeat_due;
+    MappingPacket announce;
+    bool announce_due;
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+        // Every node sees about as many peers, each one stretching its own interval keeps what a node receives in budget
+        uint16_t interval = heartbeat_interval_for(m_heartbeat_interval_ms, m_peers.high_water());
+
+        // A new interval is advertised right away, receivers then wait for the next heartbeat accordingly
+        heartbeat_due = now >= m_next_heartbeat || interval != m_heartbeat.packet_data.interval_ms;
+        if (heartbeat_due) {
+            m_heartbeat.packet_data.seq++;
+            m_heartbeat.packet_data.interval_ms = interval;
+            m_heartbeat.packet_data.view_digest = m_view_digest ^ peer_digest(m_packet.packet_data.self_uid, m_packet.packet_data.generation);
+            heartbeat = m_heartbeat;
+
+            // This runs every configured interval, half of one absorbs the timer jitter
+            m_next_heartbeat = now + interval - m_heartbeat_interval_ms / 2;
+        }
+
+        announce_due = now >= m_next_announce;
+        if (announce_due) {
+            announce = m_packet;
+
+            // +-20% jitter on every period keeps the announcements of the whole network spread out
+            std::uniform_int_distribution<uint64_t> jitter(m_announce_interval_ms * 4 / 5, m_announce_interval_ms * 6 / 5);
+            m_next_announce = now + jitter(m_rng);
+        }
+    }
+
+    if (heartbeat_due) {
+        m_map_socket->send_data<HeartbeatPacket>(heartbeat, 0);
+    }
+
+    if (announce_due) {
+        m_map_socket->send_data<MappingPacket>(announce, 0);
     }
 }
 
-void NetworkMapper::mapper_process() {
-    while(true) {
-        {
+void NetworkMapper::send_pending_delta() {
+    MappingDeltaPacket delta;
+    {
 #ifndef NO_THREADS
-            std::lock_guard<std::mutex> m{m_mapper_mutex};
+        std::lock_guard<std::mutex> m{m_mapper_mutex};
 #endif // NO_THREADS
-            mapper_update();
+        uint64_t now = oals::tstamp::now_us();
+        if (m_delta_repeats == 0 || (m_last_delta != 0 && now - m_last_delta < MAPPING_DELTA_MIN_INTERVAL_US)) {
+            return;
         }
 
-#ifdef __linux__
-        usleep(1000000);
-#endif // __linux__
+        delta.header = m_packet.header;
+        delta.header.type = PacketType::MAPPING_DELTA;
+        delta.packet_data.self_uid = m_packet.packet_data.self_uid;
+        delta.packet_data.__padding__ = 0;
+        delta.packet_data.generation = m_packet.packet_data.generation;
+        delta.packet_data.topo = m_packet.packet_data.topo;
+
+        m_last_delta = now;
+        m_delta_repeats--;
     }
+
+    m_map_socket->send_data<MappingDeltaPacket>(delta, 0);
+}
+
+void NetworkMapper::packet_receiver() {
+#ifndef NO_THREADS
+    while(m_running.load(std::memory_order_relaxed)) {
+        packet_recv_update();
+    }
+#endif // NO_THREADS
 }
 
 void NetworkMapper::process_packet(MappingPacket pck) {
-    uint64_t now = local_now();
+    uint64_t now = oals::tstamp::now_ms();
 
     PeerInfos pinfo = {};
     memcpy(&pinfo.peer_data, &pck.packet_data, sizeof(MappingData));
     pinfo.alive_stamp = now;
 
-    if(!m_peers.contains(pck.packet_data.self_uid)) {
-#ifdef __linux__
-        std::cout << "Discovered " << pck.packet_data.dev_name << " (ID = " << pck.packet_data.self_uid << ")" << std::endl;
-        std::cout << "Audio config : " << (int)pck.packet_data.topo.phy_out_count << " outs" << std::endl;
-        std::cout << "               " << (int)pck.packet_data.topo.phy_in_count << " ins" << std::endl;
-        std::cout << "               " << (int)pck.packet_data.topo.pipes_count << " pipes" << std::endl;
-#endif // __linux__
-
-        {
+    {
 #ifndef NO_THREADS
-            std::lock_guard<std::mutex> m{m_mapper_mutex};
+        std::lock_guard<std::mutex> m{m_mapper_mutex};
 #endif // NO_THREADS
-            m_peers[pck.packet_data.self_uid] = pinfo;
+        auto slot = m_peers.find(pinfo.peer_data.self_uid);
+        bool known = slot.has_value() && m_peers.hot(slot.value()).state == PEER_SLOT_KNOWN;
 
-            if (pinfo.peer_data.ck_type == CKTYPE_SLAVE) {
-#ifdef __linux__
-                std::cout << "New clock slave" << std::endl;
-#endif // __linux__
-                m_ck_slaves.emplace_back(pinfo);
-            }
+        // Periodic announcement of an unchanged peer, the common case on a large network
+        if (known && memcmp(&m_peers.cold(slot.value()), &pinfo.peer_data, sizeof(MappingData)) == 0) {
+            m_peers.touch(slot.value(), now);
+            return;
         }
 
-        m_peer_change_callback(pinfo, true);
-        m_temp_peers.erase(pck.packet_data.self_uid); // In case there was a temp peer associated with that ID, remove it
-    } else {
-        {
-#ifndef NO_THREADS
-            std::lock_guard<std::mutex> m{m_mapper_mutex};
-#endif // NO_THREADS
-            m_peers[pck.packet_data.self_uid] = pinfo;
+        // Changes and discoveries are costlier, dropped ones are retried by the digest resync
+        if (m_rx_budget == 0) {
+            return;
         }
+        m_rx_budget--;
+
+        uint32_t previous_digest = known ? peer_digest(pinfo.peer_data.self_uid, m_peers.cold(slot.value()).generation) : 0;
+
+        // Replaces the temp or cached peer associated with that ID, if any
+        slot = m_peers.upsert(pinfo.peer_data, pinfo.alive_stamp, PEER_SLOT_KNOWN);
+        if (!slot.has_value()) {
+            return;
+        }
+
+        m_view_digest ^= previous_digest ^ peer_digest(pinfo.peer_data.self_uid, pinfo.peer_data.generation);
+
+        if (known) {
+            m_cache.store(slot.value(), pinfo.peer_data);
+
+            if (pinfo.peer_data.type == DeviceType::AUDIO_DSP) {
+                m_placer.update_dsp(pinfo.peer_data.self_uid, pinfo.peer_data.topo.pipe_resmap);
+            }
+        } else {
+            register_peer(slot.value(), pinfo);
+        }
+
+        m_changed_peers.push_back(pinfo.peer_data.self_uid);
+        publish_peer_changes();
     }
 }
 
-std::optional<uint64_t> NetworkMapper::get_mac_by_uid(uint16_t uid) {
-    auto it = m_peers.find(uid);
-    if (it != m_peers.end()) {
-        return it->second.peer_data.self_address;
-    } else {
-        auto temp_it = m_temp_peers.find(uid);
-        if (temp_it != m_temp_peers.end()) {
-            return temp_it->second.peer_data.self_address;
-        }
+void NetworkMapper::register_peer(size_t slot, const PeerInfos &pinfo) {
+    // Called with the mapper mutex held, the view digest is updated by the caller
+    m_liveness[slot].reset();
+    m_cache.store(slot, pinfo.peer_data);
 
-        return {};
+    if (pinfo.peer_data.type == DeviceType::AUDIO_DSP) {
+        m_placer.update_dsp(pinfo.peer_data.self_uid, pinfo.peer_data.topo.pipe_resmap);
+    }
+
+    if (pinfo.peer_data.ck_type == CKTYPE_SLAVE) {
+        m_ck_slaves.emplace_back(pinfo);
     }
 }
 
-void NetworkMapper::update_peer_resource_mapping(NodeTopology topo, uint16_t peer_uid) {
-    if (m_peers.contains(peer_uid)) {
+void NetworkMapper::process_heartbeat(const Heartbeat &hb) {
 #ifndef NO_THREADS
-        std::lock_guard<std::mutex> m{m_mapper_mutex};
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
 #endif // NO_THREADS
-        auto peer_infos = m_peers[peer_uid];
-        peer_infos.peer_data.topo = topo;
-    } else {
+    // Heartbeats only keep known peers alive, new peers must announce themselves first
+    auto slot = m_peers.find(hb.self_uid);
+    if (!slot.has_value()) {
+        return;
+    }
+
+    PeerSlotState state = m_peers.hot(slot.value()).state;
+    // Peers with another view of the network are missing announcements, send ours early
+    uint32_t own_digest = m_view_digest ^ peer_digest(m_packet.packet_data.self_uid, m_packet.packet_data.generation);
+    uint64_t now = oals::tstamp::now_ms();
+    if (hb.view_digest != own_digest && now - m_last_resync >= MAPPER_RESYNC_MIN_INTERVAL_MS) {
+        std::uniform_int_distribution<uint64_t> jitter(0, MAPPER_RESYNC_JITTER_MS);
+        m_next_announce = std::min(m_next_announce, now + jitter(m_rng));
+        m_last_resync = now;
+    }
+
+    if (state == PEER_SLOT_PROVISIONAL) {
+        // A cached peer is alive, trust its cached data until its next announcement
+        PeerInfos pinfo = peer_infos(slot.value());
+        pinfo.alive_stamp = oals::tstamp::now_ms();
+        m_peers.upsert(pinfo.peer_data, pinfo.alive_stamp, PEER_SLOT_KNOWN);
+        m_view_digest ^= peer_digest(pinfo.peer_data.self_uid, pinfo.peer_data.generation);
+        register_peer(slot.value(), pinfo);
+
+        m_changed_peers.push_back(pinfo.peer_data.self_uid);
+        publish_peer_changes();
+    } else if (state != PEER_SLOT_KNOWN) {
         return;
     }
+
+    m_liveness[slot.value()].heartbeat(oals::tstamp::now_us(), (uint64_t)hb.interval_ms * 1000);
+    m_peers.touch(slot.value(), oals::tstamp::now_ms());
 }
 
-void NetworkMapper::update_resource_mapping(NodeTopology topo) {
+void NetworkMapper::process_delta(const MappingDelta &delta) {
 #ifndef NO_THREADS
     std::lock_guard<std::mutex> m{m_mapper_mutex};
 #endif // NO_THREADS
-    m_packet.packet_data.topo = topo;
+    auto slot = m_peers.find(delta.self_uid);
+    if (!slot.has_value() || m_peers.hot(slot.value()).state != PEER_SLOT_KNOWN) {
+        return;
+    }
+
+    // Repeated or stale delta, wraparound safe
+    if ((int32_t)(delta.generation - m_peers.cold(slot.value()).generation) <= 0) {
+        return;
+    }
+
+    m_view_digest ^= peer_digest(delta.self_uid, m_peers.cold(slot.value()).generation) ^ peer_digest(delta.self_uid, delta.generation);
+    m_peers.set_topology(slot.value(), delta.topo);
+    m_peers.set_generation(slot.value(), delta.generation);
+    m_peers.touch(slot.value(), oals::tstamp::now_ms());
+    m_cache.store(slot.value(), m_peers.cold(slot.value()));
+
+    if (m_peers.hot(slot.value()).type == DeviceType::AUDIO_DSP) {
+        m_placer.update_dsp(delta.self_uid, delta.topo.pipe_resmap);
+    }
+
+    m_changed_peers.push_back(delta.self_uid);
+    publish_peer_changes();
 }
 
-std::optional<uint16_t> NetworkMapper::find_free_dsp() const {
-    for (auto& peer : m_peers) {
-        PeerInfos infos = peer.second;
+std::optional<uint64_t> NetworkMapper::get_mac_by_uid(uint16_t uid) {
+    // Lock-free, known and temporary peers both live in the peer store
+    return m_peers.find_mac(uid);
+}
 
-        // Each bit in the resource map represent a channel, 1 if used, 0 if not. If the pipe resource map is 0
-        // then there are no free channels
-        if (infos.peer_data.type == DeviceType::AUDIO_DSP && infos.peer_data.topo.pipe_resmap != 0) {
-            return infos.peer_data.self_uid;
-        }
+void NetworkMapper::update_peer_resource_mapping(NodeTopology topo, uint16_t peer_uid) {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+    auto slot = m_peers.find(peer_uid);
+    if (!slot.has_value() || m_peers.hot(slot.value()).state != PEER_SLOT_KNOWN) {
+        return;
+    }
+
+    m_peers.set_topology(slot.value(), topo);
+
+    if (m_peers.hot(slot.value()).type == DeviceType::AUDIO_DSP) {
+        m_placer.update_dsp(peer_uid, topo.pipe_resmap);
     }
 
-    return {};
+    m_changed_peers.push_back(peer_uid);
+    publish_peer_changes();
 }
 
-std::optional<uint8_t> NetworkMapper::first_free_processing_channel(uint16_t uid) {
-    if (m_peers.contains(uid)) {
-        PeerInfos infos = m_peers[uid];
+void NetworkMapper::update_resource_mapping(NodeTopology topo) {
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+        m_packet.packet_data.topo = topo;
+        m_packet.packet_data.generation++;
+        m_delta_repeats = MAPPING_DELTA_REPEATS;
+    }
 
-        uint64_t resmap = infos.peer_data.topo.pipe_resmap;
-        for (int i = 0; i < 64; i++) {
-            if (resmap & 0x01) {
-                return i;
-            }
+    // Sent right away unless rate limited, the following packet_send_update calls send the repeats
+    if (m_map_socket) {
+        send_pending_delta();
+    }
+}
 
-            resmap >>= 1;
-        }
+std::optional<uint16_t> NetworkMapper::find_free_dsp() const {
+    // Each bit in the pipe resource map represent a pipe, 1 if free, 0 if used. Pick the DSP with the most free pipes
+    return m_placer.least_loaded_dsp();
+}
+
+std::optional<uint8_t> NetworkMapper::first_free_processing_channel(uint16_t uid) {
+    uint64_t resmap = m_placer.free_pipes(uid);
+    if (resmap == 0) {
+        return {};
     }
 
-    return {};
+    return std::countr_zero(resmap);
+}
+
+PipePlacer& NetworkMapper::get_pipe_placer() {
+    return m_placer;
 }
 
 uint64_t NetworkMapper::local_now() {
-#if defined(__linux__) || defined(__ZEPHYR__)
-    return std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::high_resolution_clock::now().time_since_epoch()
-    ).count();
-#else
-    return _now_ms();
-#endif
+    return oals::tstamp::now_epoch_ms();
 }
 
 uint64_t NetworkMapper::local_now_us() {
-#if defined(__linux__) || defined(__ZEPHYR__)
-    return std::chrono::duration_cast<std::chrono::microseconds>(
-            std::chrono::high_resolution_clock::now().time_since_epoch()
-    ).count();
-#else
-    return _now_us();
-#endif
+    return oals::tstamp::now_epoch_us();
+}
+
+uint16_t NetworkMapper::heartbeat_interval_for(uint16_t base_interval_ms, size_t peers) {
+    uint64_t interval = std::max<uint16_t>(base_interval_ms, 1);
+
+    // Doubling, the interval does not change on every join or loss
+    while (peers * 1000 / interval > MAPPER_HEARTBEAT_BUDGET && interval * 2 <= UINT16_MAX) {
+        interval *= 2;
+    }
+
+    return interval;
 }
 
 std::optional<NodeTopology> NetworkMapper::get_device_topo(uint16_t peer_uid) {
-    if (m_peers.contains(peer_uid)) {
-        return m_peers[peer_uid].peer_data.topo;
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+    if (m_peers.contains(peer_uid, PEER_SLOT_KNOWN)) {
+        return m_peers.cold(m_peers.find(peer_uid).value()).topo;
     } else {
         return {};
     }
@@ -278,23 +589,139 @@ std::optional<NodeTopology> NetworkMapper::get_device_topo(uint16_t peer_uid) {
 std::vector<uint16_t> NetworkMapper::find_all_control_surfaces() {
     std::vector<uint16_t> surfaces;
 
-    for (auto& device : m_peers) {
-        if (device.second.peer_data.type == DeviceType::CONTROL_SURFACE) {
-            surfaces.push_back(device.first);
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+
+    for (size_t slot = 0; slot < m_peers.high_water(); slot++) {
+        const PeerHot& hot = m_peers.hot(slot);
+        if (hot.state == PEER_SLOT_KNOWN && hot.type == DeviceType::CONTROL_SURFACE) {
+            surfaces.push_back(hot.uid);
         }
     }
 
     return surfaces;
 }
 
-void NetworkMapper::set_peer_change_callback(std::function<void(PeerInfos &, bool)> callback) {
-    m_peer_change_callback = std::move(callback);
+void NetworkMapper::set_peer_event_callback(std::function<void(PeerInfos &, bool)> callback) {
+    m_peer_event_callback = std::move(callback);
+}
+
+size_t NetworkMapper::dispatch_peer_events(size_t max_events) {
+    size_t dispatched = 0;
+    PeerEvent event;
+
+    while (dispatched < max_events && m_events.poll(event)) {
+        m_peer_event_callback(event.peer, event.type != PEER_LOST);
+        dispatched++;
+    }
+
+    return dispatched;
+}
+
+bool NetworkMapper::poll_peer_event(PeerEvent &event) {
+    return m_events.poll(event);
+}
+
+std::shared_ptr<const PeerSnapshot> NetworkMapper::get_peer_snapshot() const {
+    return m_events.snapshot();
+}
+
+void NetworkMapper::publish_peer_changes() {
+    // Called with the mapper mutex held
+    if (m_changed_peers.empty()) {
+        return;
+    }
+
+    std::vector<PeerInfos> peers;
+    for (size_t slot = 0; slot < m_peers.high_water(); slot++) {
+        if (m_peers.hot(slot).state == PEER_SLOT_KNOWN) {
+            peers.push_back(peer_infos(slot));
+        }
+    }
+
+    m_events.publish(std::move(peers), m_changed_peers);
+    m_changed_peers.clear();
 }
 
 std::vector<PeerInfos> NetworkMapper::get_clock_slaves() {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
     return m_ck_slaves;
 }
 
+std::vector<PeerInfos> NetworkMapper::get_clock_masters() {
+    std::vector<PeerInfos> masters;
+
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+    for (size_t slot = 0; slot < m_peers.high_water(); slot++) {
+        const PeerHot& hot = m_peers.hot(slot);
+        if (hot.state == PEER_SLOT_KNOWN && hot.ck_type == CKTYPE_MASTER) {
+            masters.push_back(peer_infos(slot));
+        }
+    }
+
+    return masters;
+}
+
 void NetworkMapper::add_temp_peer(uint16_t uid, const PeerInfos &infos) {
-    m_temp_peers[uid] = std::move(infos);
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_mapper_mutex};
+#endif // NO_THREADS
+    if (m_peers.contains(uid, PEER_SLOT_KNOWN) || m_peers.contains(uid, PEER_SLOT_PROVISIONAL)) {
+        return;
+    }
+
+    MappingData data = infos.peer_data;
+    data.self_uid = uid;
+    m_peers.upsert(data, oals::tstamp::now_ms(), PEER_SLOT_TEMP);
+}
+
+void NetworkMapper::mark_peer_used(uint16_t uid) {
+    m_peers.mark_used(uid, oals::tstamp::now_ms());
+}
+
+PeerStoreStats NetworkMapper::get_peer_store_stats() const {
+    return m_peers.stats();
+}
+
+uint32_t NetworkMapper::peer_digest(uint16_t uid, uint32_t generation) {
+    // 32 bits finalizer of MurmurHash3, combined by XOR so that peers can be added and removed in any order
+    uint32_t h = ((uint32_t)uid << 16) ^ generation ^ (generation >> 16) * 0x9E3779B9u;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+
+    return h;
+}
+
+size_t NetworkMapper::packet_recv_batch(size_t budget) {
+    size_t processed = 0;
+
+    while (processed < budget) {
+        alignas(std::max_align_t) uint8_t raw_packet_buffer[sizeof(LowLatPacket<MappingPacket>)];
+        int rx_data = m_map_socket->receive_data_raw(reinterpret_cast<char*>(raw_packet_buffer), sizeof(raw_packet_buffer), true);
+
+        if (rx_data <= 0) {
+            break;
+        }
+
+        process_frame(raw_packet_buffer, (size_t)rx_data);
+        processed++;
+    }
+
+    return processed;
+}
+
+PeerInfos NetworkMapper::peer_infos(size_t slot) const {
+    PeerInfos infos = {};
+    infos.peer_data = m_peers.cold(slot);
+    infos.alive_stamp = m_peers.hot(slot).alive_stamp;
+
+    return infos;
 }
@@ -7,35 +7,50 @@
 #define OPENAUDIONETWORK_NETWORKMAPPER_H
 
 #ifndef NO_THREADS
+#include <atomic>
 #include <thread>
 #include <mutex>
 #endif // NO_THREADS
 
 #include <memory>
 #include <cstring>
-#include <unordered_map>
 #include <algorithm>
 #include <optional>
 #include <functional>
 #include <chrono>
+#include <bit>
+#include <random>
 
 #include "netutils/LowLatSocket.h"
+#include "netutils/tstamp.h"
 #include "packet_structs.h"
+#include "PeerStore.h"
+#include "PipePlacer.h"
+#include "FailureDetector.h"
+#include "TimerWheel.h"
+#include "PeerCache.h"
+#include "PeerEvents.h"
+#include "packet_view.h"
 
 #include "peer/peer_conf.h"
 
-/**
- * @struct PeerInfos
- * @brief Stores other visible devices infos
- */
-struct PeerInfos {
-    MappingData peer_data;  /**< Device infos */
-    uint64_t alive_stamp;   /**< Last alive message timestamp */
-};
+#define MAPPING_DELTA_MIN_INTERVAL_US 2000  /**< Minimum delay between two topology delta announcements */
+#define MAPPING_DELTA_REPEATS 3             /**< Number of times each topology delta is sent */
+#define MAPPER_RX_BUDGET 64                 /**< New or changed announcements processed per mapper tick */
+#define MAPPER_HEARTBEAT_BUDGET 2000        /**< Heartbeats per second a node should receive at most */
+#define MAPPER_RESYNC_MIN_INTERVAL_MS 1000  /**< Minimum time between two early announcements on digest mismatch */
+#define MAPPER_RESYNC_JITTER_MS 200         /**< Early announcements are spread over this window */
+#define PEER_CACHE_MAX_AGE_MS 600000        /**< Cached peers older than this are not restored */
+#define PEER_TEMP_TTL_MS 30000              /**< Temporary peers without traffic for this long are forgotten */
 
 /**
  * @class NetworkMapper
  * @brief Establishes a network map of all the visible OAN devices in LAN.
+ *
+ * Peer tables are fixed size, allocated with the mapper: the peer store, plus a failure detector and a peer cache
+ * entry per store slot, about 456 bytes per peer of PEER_STORE_CAPACITY (OAN_PEER_STORE_CAPACITY in CMake), on top of
+ * 67 KiB of fixed tables (mostly the pending flags of the event queue). The mapper takes 523 KiB with the default
+ * 1024 peers, 96 KiB with the 64 of embedded builds. Allocate it on the heap.
  */
 class NetworkMapper {
 public:
@@ -49,47 +64,90 @@ public:
     /**
      * Network Mapper initialization
      * @param iface Physical network interface name to start the mapping on
+     * @param peer_cache_path Optional peer cache file. Peers persisted there by a previous run are restored as
+     * provisional entries, addressable right away and confirmed or expired by live traffic. Linux only.
      * @return true if initialization succeeds
      */
-    bool init_mapper(const std::string& iface);
+    bool init_mapper(const std::string& iface, const std::string& peer_cache_path = {});
 
     /**
-     * Launch two threads which scan and map the network
+     * Schedule the announcements and the liveness checks on a timer wheel. NO_THREADS hosts advance the wheel and
+     * call packet_recv_update from their loop.
+     * @param wheel Timer wheel, must outlive the mapper or stop_mapping_process must be called first
+     */
+    void schedule_on(TimerWheel& wheel);
+
+    /**
+     * Launch the mapping process on a private timer wheel thread, plus the receiving thread. No-op in NO_THREADS
+     * builds: the host calls schedule_on, then advances its wheel and calls packet_recv_update from its loop.
      */
     void launch_mapping_process();
 
     /**
-     * Find a device MAC address based on its UID.
+     * Launch the mapping process on a shared timer wheel, plus the receiving thread. In NO_THREADS builds only
+     * schedules on the wheel, the host calls packet_recv_update from its loop.
+     * @param wheel Timer wheel, launched or advanced by the caller
+     */
+    void launch_mapping_process(TimerWheel& wheel);
+
+    /**
+     * Cancel the mapper timers and join the receiving thread. Called by the destructor.
+     */
+    void stop_mapping_process();
+
+    /**
+     * Configure the peer liveness detection. Heartbeats are sent every heartbeat interval, the full mapping data
+     * every announce interval with a +-20% jitter, or earlier when a heartbeat shows a peer with another view of the
+     * network. On large networks the heartbeat interval is stretched, see heartbeat_interval_for.
+     * Call before scheduling the mapping process.
+     * @param heartbeat_interval_ms Heartbeat interval, 50 ms by default
+     * @param announce_interval_ms Mapping announcement interval, 5 s by default
+     * @param phi_threshold Failure detector suspicion threshold @see FailureDetector
+     */
+    void configure_liveness(uint16_t heartbeat_interval_ms, uint32_t announce_interval_ms, double phi_threshold = 8.0);
+
+    /**
+     * Find a device MAC address based on its UID. Lock-free, safe to call from audio threads while the
+     * mapper threads update the peer table.
      * @param uid UID to find
      * @return If found, the corresponding MAC address.
      */
     std::optional<uint64_t> get_mac_by_uid(uint16_t uid);
 
     /**
-     * Update self resource mapping
+     * Update self resource mapping. The change is announced immediately to the peers with a new generation, then
+     * repeated on the next heartbeats in case of loss.
      * @param topo New topology
      */
     void update_resource_mapping(NodeTopology topo);
 
     /**
-     * Update local memory about pipe resource mapping
+     * Update local memory about pipe resource mapping, until the peer announces its own
      * @param topo Temporary deduced topology of peer
+     * @param peer_uid Peer to update
      */
     void update_peer_resource_mapping(NodeTopology topo, uint16_t peer_uid);
 
     /**
-     * Finds a DSP Device in the network that has space for new pipes
+     * Finds the DSP Device in the network with the most space for new pipes
      * @return If found, DSP ID
      */
     std::optional<uint16_t> find_free_dsp() const;
 
     /**
-     * Finds a free processing channel in a given device
+     * Finds a free processing channel in a given device, pipes reserved through the placer excluded
      * @param uid Device to search on
      * @return If found, channel index
      */
     std::optional<uint8_t> first_free_processing_channel(uint16_t uid);
 
+    /**
+     * Get the pipe placement engine, fed with the DSPs discovered by the mapper. Reserve pipes there before sending
+     * a ControlPipeCreate and release them if the creation fails.
+     * @return Pipe placer
+     */
+    PipePlacer& get_pipe_placer();
+
     /**
      * Finds given device topology
      * @param peer_uid Device to search
@@ -104,7 +162,8 @@ public:
     std::vector<uint16_t> find_all_control_surfaces();
 
     /**
-     * Install a callback called whenever a peer changes
+     * Install a callback called whenever a peer changes. It only runs from dispatch_peer_events, on the thread
+     * calling it: the application must call dispatch_peer_events from its loop.
      *
      * Callback signature void callback(PeerInfos& peer, bool peer_state)
      *
@@ -112,10 +171,37 @@ public:
      *
      * peer_state : true if still in network, false is it is gone from the network
      *
-     * @warning The callback function MUST be thread-safe
      * @param callback Function to be called
      */
-    void set_peer_change_callback(std::function<void(PeerInfos&, bool)> callback);
+    void set_peer_event_callback(std::function<void(PeerInfos&, bool)> callback);
+
+    /**
+     * Removed. Its callback used to run on the mapper threads by itself, callers relying on that would silently stop
+     * getting peer changes: use set_peer_event_callback with dispatch_peer_events, or poll_peer_event.
+     */
+    void set_peer_change_callback(std::function<void(PeerInfos&, bool)> callback) = delete;
+
+    /**
+     * Run the peer change callback for the pending peer events, on the calling thread. The mapper threads only
+     * queue events, a slow callback never delays discovery or liveness checks.
+     * Call from a single thread, exclusive with poll_peer_event.
+     * @param max_events Maximum number of events dispatched
+     * @return Number of events dispatched
+     */
+    size_t dispatch_peer_events(size_t max_events = SIZE_MAX);
+
+    /**
+     * Get the next peer event. Changes of a peer made while an event for it is pending are coalesced.
+     * Call from a single thread, exclusive with dispatch_peer_events.
+     * @param event Filled with the event and the peer table including it
+     * @return false if no event is pending
+     */
+    bool poll_peer_event(PeerEvent& event);
+
+    /**
+     * @return Latest published peer table, safe from any thread
+     */
+    std::shared_ptr<const PeerSnapshot> get_peer_snapshot() const;
 
     /**
      * Adds a temporary peer that we don't know much about. Essentially here to avoid packets
@@ -125,6 +211,17 @@ public:
      */
     void add_temp_peer(uint16_t uid, const PeerInfos& infos);
 
+    /**
+     * Record traffic from a peer, keeping a temporary peer from being evicted or expired. Lock-free.
+     * @param uid Peer UID
+     */
+    void mark_peer_used(uint16_t uid);
+
+    /**
+     * @return Peer store counters, including the peers dropped because the store is full. Safe from any thread
+     */
+    PeerStoreStats get_peer_store_stats() const;
+
     /**
      * Retreive all known clock slaves
      * @return List of the clock slaves on the network
@@ -132,26 +229,52 @@ public:
     std::vector<PeerInfos> get_clock_slaves();
 
     /**
-     * Get the local UNIX time in ms
-     * @return Local UNIX time in ms
+     * Retreive all known clock masters, except self
+     * @return List of the other clock masters on the network
+     */
+    std::vector<PeerInfos> get_clock_masters();
+
+    /**
+     * Get the local time since the Unix epoch in ms
+     * @deprecated Use oals::tstamp::now_epoch_ms
+     * @return Local time in ms
      */
     static uint64_t local_now();
 
     /**
-     * Get the local UNIX time in us
-     * @return Local UNIX time in us
+     * Get the local time since the Unix epoch in us
+     * @deprecated Use oals::tstamp::now_epoch_us
+     * @return Local time in us
      */
     static uint64_t local_now_us();
 
+    /**
+     * Heartbeat interval used on a network of the given size. The configured interval is doubled until the
+     * heartbeats of every peer stay within MAPPER_HEARTBEAT_BUDGET per second.
+     * @param base_interval_ms Configured heartbeat interval
+     * @param peers Number of peers on the network
+     * @return Heartbeat interval in ms
+     */
+    static uint16_t heartbeat_interval_for(uint16_t base_interval_ms, size_t peers);
+
     void mapper_update();
     void packet_send_update();
     void packet_recv_update();
-private:
+
     /**
-     * Main mapper process
+     * Drain the mapping socket without blocking, for NO_THREADS hosts polling from their loop
+     * @param budget Maximum number of frames to process
+     * @return Number of frames processed
      */
-    void mapper_process();
-    void packet_sender();
+    size_t packet_recv_batch(size_t budget);
+
+    /**
+     * Process a mapping frame received outside the mapping socket (other transport, network simulation)
+     * @param buffer Ethernet frame
+     * @param size Frame size
+     */
+    void process_frame(uint8_t* buffer, size_t size);
+private:
     void packet_receiver();
 
     /**
@@ -161,24 +284,56 @@ private:
     void update_packet(const PeerConf& pconf);
 
     void process_packet(MappingPacket pck);
+    void process_heartbeat(const Heartbeat& hb);
+    void process_delta(const MappingDelta& delta);
+    void register_peer(size_t slot, const PeerInfos& pinfo);
+    void load_peer_cache();
+    void publish_peer_changes();
+    void send_pending_delta();
+
+    /**
+     * Rebuild the full peer infos of a store slot
+     * @param slot Peer store slot
+     */
+    PeerInfos peer_infos(size_t slot) const;
+    static uint32_t peer_digest(uint16_t uid, uint32_t generation);
 
     MappingPacket m_packet;
+    HeartbeatPacket m_heartbeat;
+    uint16_t m_heartbeat_interval_ms;
+    uint32_t m_announce_interval_ms;
+    uint64_t m_next_announce;
+    uint64_t m_next_heartbeat;
+    uint64_t m_last_resync;
+    size_t m_rx_budget;
+    uint32_t m_view_digest;         // XOR of the digests of the known peers
+    std::minstd_rand m_rng;
+    uint64_t m_last_delta;
+    uint8_t m_delta_repeats;
     uint32_t m_netmask;
     uint16_t m_mapping_port;
 
     std::unique_ptr<LowLatSocket> m_map_socket;
 
-    std::unordered_map<int, PeerInfos> m_peers;
-    std::unordered_map<int, PeerInfos> m_temp_peers;
+    PeerStore m_peers;
+    PipePlacer m_placer;
+    std::array<FailureDetector, PEER_STORE_CAPACITY> m_liveness;  // Indexed by peer store slot
+    PeerCache m_cache;                                              // Indexed by peer store slot
     std::vector<PeerInfos> m_ck_slaves;
 
-    std::function<void(PeerInfos&, bool)> m_peer_change_callback;
+    std::function<void(PeerInfos&, bool)> m_peer_event_callback;
+    PeerEventQueue m_events;
+    std::vector<uint16_t> m_changed_peers;      // Changed since the last publication
+
+    TimerWheel* m_wheel;
+    TimerId m_send_timer;
+    TimerId m_liveness_timer;
 
 #ifndef NO_THREADS
-    std::thread m_tx_thread;
+    std::unique_ptr<TimerWheel> m_own_wheel;
     std::thread m_rx_thread;
-    std::thread m_mapper_thread;
-    std::mutex m_mapper_mutex;
+    std::atomic<bool> m_running;
+    mutable std::mutex m_mapper_mutex;
 #endif // NO_THREADS
 };
 
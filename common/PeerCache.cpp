@@ -0,0 +1,148 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "PeerCache.h"
+
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ctime>
+#endif // __linux__
+
+PeerCache::PeerCache() {
+    m_fd = -1;
+    m_size = 0;
+    m_header = nullptr;
+    m_entries = nullptr;
+}
+
+PeerCache::~PeerCache() {
+    close();
+}
+
+bool PeerCache::open(const std::string &path) {
+    close();
+
+#ifdef __linux__
+    m_size = sizeof(CacheHeader) + sizeof(PeerCacheEntry) * PEER_STORE_CAPACITY;
+
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    struct stat st{};
+    bool fresh = fstat(m_fd, &st) != 0 || (size_t)st.st_size != m_size;
+    if (fresh && ftruncate(m_fd, (off_t)m_size) != 0) {
+        close();
+        return false;
+    }
+
+    void* map = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    m_header = static_cast<CacheHeader*>(map);
+    m_entries = reinterpret_cast<PeerCacheEntry*>(static_cast<uint8_t*>(map) + sizeof(CacheHeader));
+
+    // Written by another build of the stack, or not a cache at all
+    if (fresh || m_header->magic != PEER_CACHE_MAGIC || m_header->version != PEER_CACHE_VERSION
+        || m_header->entry_size != sizeof(PeerCacheEntry) || m_header->capacity != PEER_STORE_CAPACITY) {
+        memset(map, 0, m_size);
+        m_header->magic = PEER_CACHE_MAGIC;
+        m_header->version = PEER_CACHE_VERSION;
+        m_header->entry_size = sizeof(PeerCacheEntry);
+        m_header->capacity = PEER_STORE_CAPACITY;
+    }
+
+    return true;
+#else
+    return false;
+#endif // __linux__
+}
+
+void PeerCache::close() {
+#ifdef __linux__
+    if (m_header != nullptr) {
+        msync(m_header, m_size, MS_ASYNC);
+        munmap(m_header, m_size);
+    }
+
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif // __linux__
+
+    m_fd = -1;
+    m_header = nullptr;
+    m_entries = nullptr;
+}
+
+bool PeerCache::is_open() const {
+    return m_entries != nullptr;
+}
+
+std::vector<PeerCacheEntry> PeerCache::load(uint64_t max_age_ms) const {
+    std::vector<PeerCacheEntry> entries;
+    if (!is_open()) {
+        return entries;
+    }
+
+    uint64_t now = wall_now_ms();
+    for (size_t i = 0; i < PEER_STORE_CAPACITY; i++) {
+        const PeerCacheEntry& e = m_entries[i];
+        if (e.valid == 1 && e.data.self_uid != 0 && e.last_seen <= now && now - e.last_seen <= max_age_ms) {
+            entries.push_back(e);
+        }
+    }
+
+    return entries;
+}
+
+void PeerCache::store(size_t slot, const MappingData &data, uint64_t last_seen) {
+    if (!is_open() || slot >= PEER_STORE_CAPACITY) {
+        return;
+    }
+
+    PeerCacheEntry& e = m_entries[slot];
+    e.data = data;
+    e.last_seen = last_seen == 0 ? wall_now_ms() : last_seen;
+    e.valid = 1;
+}
+
+void PeerCache::erase(size_t slot) {
+    if (!is_open() || slot >= PEER_STORE_CAPACITY) {
+        return;
+    }
+
+    m_entries[slot].valid = 0;
+}
+
+void PeerCache::clear() {
+    if (!is_open()) {
+        return;
+    }
+
+    for (size_t i = 0; i < PEER_STORE_CAPACITY; i++) {
+        m_entries[i].valid = 0;
+    }
+}
+
+uint64_t PeerCache::wall_now_ms() {
+#ifdef __linux__
+    // Monotonic clocks restart with the machine, the cache has to survive reboots
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#else
+    return 0;
+#endif // __linux__
+}
@@ -0,0 +1,104 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef PEERCACHE_H
+#define PEERCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "packet_structs.h"
+#include "PeerStore.h"
+
+#define PEER_CACHE_MAGIC 0x504E414F      // "OANP"
+#define PEER_CACHE_VERSION 1
+
+/**
+ * @struct PeerCacheEntry
+ * @brief Persisted peer, one per peer store slot
+ */
+struct PeerCacheEntry {
+    MappingData data;       /**< Last known mapping data */
+    uint64_t last_seen;     /**< Wall clock time of the last announcement, ms since epoch */
+    uint8_t valid;          /**< 1 if the entry holds a peer */
+    uint8_t __padding__[7];
+};
+
+/**
+ * @class PeerCache
+ * @brief Peer table persisted in a memory mapped file, so that a restarted node can address its peers before their
+ * next announcement. Entries are written in place when the mapper learns or loses a peer, the kernel writes them
+ * back to the file. Linux only, the cache stays closed on other platforms.
+ */
+class PeerCache {
+public:
+    PeerCache();
+    ~PeerCache();
+
+    /**
+     * Open or create the cache file. A file with another layout is reset.
+     * @param path Cache file path
+     * @return true if the cache is usable
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmap and close the cache file
+     */
+    void close();
+
+    /**
+     * @return true if the cache file is open
+     */
+    bool is_open() const;
+
+    /**
+     * Read the persisted peers
+     * @param max_age_ms Entries not seen for longer are ignored
+     * @return Valid entries
+     */
+    std::vector<PeerCacheEntry> load(uint64_t max_age_ms) const;
+
+    /**
+     * Persist a peer
+     * @param slot Peer store slot of the peer
+     * @param data Peer mapping data
+     * @param last_seen Wall clock time the peer was last seen in ms, 0 for now
+     */
+    void store(size_t slot, const MappingData& data, uint64_t last_seen = 0);
+
+    /**
+     * Forget a peer
+     * @param slot Peer store slot of the peer
+     */
+    void erase(size_t slot);
+
+    /**
+     * Forget every peer
+     */
+    void clear();
+
+private:
+    struct CacheHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t entry_size;
+        uint32_t capacity;
+        uint32_t __padding__;
+    };
+
+    static uint64_t wall_now_ms();
+
+    int m_fd;
+    size_t m_size;
+    CacheHeader* m_header;
+    PeerCacheEntry* m_entries;
+};
+
+
+
+#endif //PEERCACHE_H
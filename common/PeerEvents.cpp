@@ -0,0 +1,88 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "PeerEvents.h"
+
+#include <cstring>
+
+static constexpr uint8_t PENDING_QUEUED = 1;   // UID is in the queue
+static constexpr uint8_t PENDING_LEFT = 2;     // UID was absent from a snapshot since it was queued
+
+const PeerInfos* PeerSnapshot::find(uint16_t uid) const {
+    for (const PeerInfos& peer : peers) {
+        if (peer.peer_data.self_uid == uid) {
+            return &peer;
+        }
+    }
+
+    return nullptr;
+}
+
+PeerEventQueue::PeerEventQueue() {
+    for (auto& pending : m_pending) {
+        pending.store(0, std::memory_order_relaxed);
+    }
+
+    m_version = 0;
+    m_snapshot.store(std::make_shared<const PeerSnapshot>(PeerSnapshot{0, {}}));
+}
+
+void PeerEventQueue::publish(std::vector<PeerInfos> peers, const std::vector<uint16_t> &changed) {
+    // The snapshot is visible before the UIDs are queued, the consumer always sees the change it is told about
+    auto snapshot = std::make_shared<const PeerSnapshot>(PeerSnapshot{++m_version, std::move(peers)});
+    m_snapshot.store(snapshot);
+
+    for (uint16_t uid : changed) {
+        uint8_t flags = PENDING_QUEUED | (snapshot->find(uid) == nullptr ? PENDING_LEFT : 0);
+
+        if ((m_pending[uid].fetch_or(flags) & PENDING_QUEUED) == 0) {
+            m_queue.enqueue(uid);
+        }
+    }
+}
+
+bool PeerEventQueue::poll(PeerEvent &event) {
+    uint16_t uid;
+
+    while (m_queue.try_dequeue(uid)) {
+        // Cleared before reading the snapshot, a later change queues the UID again
+        uint8_t flags = m_pending[uid].exchange(0);
+
+        auto snapshot = m_snapshot.load();
+        const PeerInfos* current = snapshot->find(uid);
+        auto delivered = m_delivered.find(uid);
+
+        if (current != nullptr && (delivered == m_delivered.end() || (flags & PENDING_LEFT) != 0)) {
+            event.type = PEER_JOINED;
+            event.peer = *current;
+            m_delivered[uid] = *current;
+        } else if (current != nullptr) {
+            // Liveness refreshes alone are not changes
+            if (memcmp(&current->peer_data, &delivered->second.peer_data, sizeof(MappingData)) == 0) {
+                continue;
+            }
+
+            event.type = PEER_CHANGED;
+            event.peer = *current;
+            delivered->second = *current;
+        } else if (delivered != m_delivered.end()) {
+            event.type = PEER_LOST;
+            event.peer = delivered->second;
+            m_delivered.erase(delivered);
+        } else {
+            // Joined and left before the application looked
+            continue;
+        }
+
+        event.snapshot = std::move(snapshot);
+        return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<const PeerSnapshot> PeerEventQueue::snapshot() const {
+    return m_snapshot.load();
+}
@@ -0,0 +1,102 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef PEEREVENTS_H
+#define PEEREVENTS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/concurrentqueue.h"
+#include "PeerStore.h"
+
+/**
+ * @struct PeerSnapshot
+ * @brief Immutable copy of the known peers, published by the mapper after each change
+ */
+struct PeerSnapshot {
+    uint64_t version;               /**< Incremented by each published snapshot */
+    std::vector<PeerInfos> peers;   /**< Known peers, in peer store order */
+
+    /**
+     * @param uid Peer UID
+     * @return The peer, nullptr if it is not in the snapshot
+     */
+    const PeerInfos* find(uint16_t uid) const;
+};
+
+/**
+ * @enum PeerEventType
+ * @brief What changed for a peer since the previous event delivered for it
+ */
+enum PeerEventType : uint8_t {
+    PEER_JOINED = 0,    /**< Peer discovered, or back after a loss not reported yet (restart): its state must be rebuilt */
+    PEER_CHANGED,       /**< Mapping data of a known peer changed (topology, name, clock role...) */
+    PEER_LOST           /**< Peer gone from the network */
+};
+
+/**
+ * @struct PeerEvent
+ * @brief Peer change, with the peer table as it was when the event was built
+ */
+struct PeerEvent {
+    PeerEventType type;                             /**< Change type */
+    PeerInfos peer;                                 /**< Peer, its last known state for PEER_LOST */
+    std::shared_ptr<const PeerSnapshot> snapshot;   /**< Consistent peer table including this change */
+};
+
+/**
+ * @class PeerEventQueue
+ * @brief Hands peer changes from the mapper threads to the application without running application code on them.
+ * The producer marks changed UIDs and publishes a new snapshot, a UID is queued once until it is consumed, so a
+ * peer flapping faster than the application polls yields a single event. Events are rebuilt on the consumer side by
+ * comparing the latest snapshot with what was already delivered: a peer which joined and left between two polls
+ * produces nothing, a peer changed several times produces one PEER_CHANGED and a peer restarted between two polls
+ * produces PEER_JOINED again.
+ *
+ * The UID queue and flags are lock free, only the snapshot pointer swap is briefly serialized. One producer
+ * (serialized by the mapper mutex) and one consumer thread.
+ */
+class PeerEventQueue {
+public:
+    PeerEventQueue();
+    ~PeerEventQueue() = default;
+
+    /**
+     * Publish a new snapshot and queue the UIDs it changed. Producer side.
+     * @param peers Known peers
+     * @param changed UIDs changed since the previous publication
+     */
+    void publish(std::vector<PeerInfos> peers, const std::vector<uint16_t>& changed);
+
+    /**
+     * Get the next event. Consumer side.
+     * @param event Filled with the event
+     * @return false if no event is pending
+     */
+    bool poll(PeerEvent& event);
+
+    /**
+     * @return Latest snapshot, safe from any thread
+     */
+    std::shared_ptr<const PeerSnapshot> snapshot() const;
+
+private:
+    moodycamel::ConcurrentQueue<uint16_t> m_queue;
+    std::array<std::atomic<uint8_t>, 65536> m_pending;    // PENDING_* flags per UID
+    std::atomic<std::shared_ptr<const PeerSnapshot>> m_snapshot;
+    uint64_t m_version;
+
+    // Consumer side, peers as last delivered to the application
+    std::unordered_map<uint16_t, PeerInfos> m_delivered;
+};
+
+
+
+#endif //PEEREVENTS_H
@@ -0,0 +1,308 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "PeerStore.h"
+
+static_assert(PEER_STORE_CAPACITY < UINT16_MAX, "Slots must fit in the UID index");
+
+static inline size_t index_home(uint16_t uid, size_t size) {
+    // Fibonacci hashing on the top bits, consecutive UIDs land far apart
+    return ((uint32_t)uid * 2654435769u) >> (32 - std::countr_zero(size));
+}
+static_assert(sizeof(PeerHot) == 32, "Hot peer data must stay half a cache line");
+
+PeerStore::PeerStore(): m_index_seq(0), m_high_water(0) {
+    for (auto& i : m_index) {
+        i.store(INDEX_EMPTY, std::memory_order_relaxed);
+    }
+
+    for (auto& u : m_last_used) {
+        u.store(0, std::memory_order_relaxed);
+    }
+
+    m_temp_count = 0;
+    m_temp_inserted = 0;
+    m_temp_evicted = 0;
+    m_temp_expired = 0;
+    m_rejected = 0;
+
+    for (auto& h : m_hot) {
+        h.mac.store(0, std::memory_order_relaxed);
+        h.alive_stamp = 0;
+        h.pipe_resmap = 0;
+        h.uid = 0;
+        h.type = DeviceType::CONTROL_SURFACE;
+        h.ck_type = CKTYPE_NONE;
+        h.state = PEER_SLOT_FREE;
+    }
+}
+
+uint16_t PeerStore::index_find(uint16_t uid, std::memory_order order) const {
+    while (true) {
+        uint32_t seq = m_index_seq.load(std::memory_order_acquire);
+        size_t pos = index_home(uid, INDEX_SIZE);
+        uint16_t idx = 0;
+
+        // Bounded, the writer keeps at least half of the entries empty
+        for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+            uint32_t entry = m_index[pos].load(order);
+            if (entry == INDEX_EMPTY || (entry >> 16) == uid) {
+                idx = entry & 0xFFFF;
+                break;
+            }
+
+            pos = (pos + 1) & (INDEX_SIZE - 1);
+        }
+
+        // A removal may have moved the entry behind the probe, look again. The acquire loads of the entries keep
+        // this load after them
+        if ((seq & 1) == 0 && m_index_seq.load(std::memory_order_relaxed) == seq) {
+            return idx;
+        }
+    }
+}
+
+void PeerStore::index_insert(uint16_t uid, size_t slot) {
+    size_t pos = index_home(uid, INDEX_SIZE);
+
+    for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+        uint32_t entry = m_index[pos].load(std::memory_order_relaxed);
+        if (entry == INDEX_EMPTY || (entry >> 16) == uid) {
+            break;
+        }
+
+        pos = (pos + 1) & (INDEX_SIZE - 1);
+    }
+
+    m_index[pos].store(((uint32_t)uid << 16) | (slot + 1), std::memory_order_release);
+}
+
+void PeerStore::index_erase(uint16_t uid) {
+    size_t pos = index_home(uid, INDEX_SIZE);
+
+    for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+        uint32_t entry = m_index[pos].load(std::memory_order_relaxed);
+        if (entry == INDEX_EMPTY) {
+            return;
+        }
+
+        if ((entry >> 16) == uid) {
+            break;
+        }
+
+        pos = (pos + 1) & (INDEX_SIZE - 1);
+    }
+
+    uint32_t seq = m_index_seq.load(std::memory_order_relaxed);
+    m_index_seq.store(seq + 1, std::memory_order_relaxed);
+
+    // Backward shift: the following entries of the cluster that may live in the hole move into it, so no tombstone
+    // is left and lookups of absent UIDs stop at the first empty entry
+    size_t hole = pos;
+    size_t next = (hole + 1) & (INDEX_SIZE - 1);
+    while (true) {
+        uint32_t entry = m_index[next].load(std::memory_order_relaxed);
+        if (entry == INDEX_EMPTY) {
+            break;
+        }
+
+        size_t home = index_home(entry >> 16, INDEX_SIZE);
+        if (((next - home) & (INDEX_SIZE - 1)) >= ((next - hole) & (INDEX_SIZE - 1))) {
+            m_index[hole].store(entry, std::memory_order_release);
+            hole = next;
+        }
+
+        next = (next + 1) & (INDEX_SIZE - 1);
+    }
+
+    m_index[hole].store(INDEX_EMPTY, std::memory_order_release);
+    m_index_seq.store(seq + 2, std::memory_order_release);
+}
+
+std::optional<uint64_t> PeerStore::find_mac(uint16_t uid) const {
+    uint16_t idx = index_find(uid, std::memory_order_acquire);
+    if (idx == 0) {
+        return {};
+    }
+
+    // The slot may have been recycled since the index was read, the UID stored with the MAC tells
+    uint64_t entry = m_hot[idx - 1].mac.load(std::memory_order_acquire);
+    if (entry == 0 || (entry >> 48) != uid) {
+        return {};
+    }
+
+    return entry & MAC_MASK;
+}
+
+std::optional<size_t> PeerStore::find(uint16_t uid) const {
+    uint16_t idx = index_find(uid, std::memory_order_relaxed);
+    if (idx == 0) {
+        return {};
+    }
+
+    return idx - 1;
+}
+
+bool PeerStore::contains(uint16_t uid, PeerSlotState state) const {
+    auto slot = find(uid);
+    return slot.has_value() && m_hot[slot.value()].state == state;
+}
+
+std::optional<size_t> PeerStore::upsert(const MappingData &data, uint64_t alive_stamp, PeerSlotState state) {
+    if (data.self_uid == 0 || state == PEER_SLOT_FREE) {
+        return {};
+    }
+
+    auto slot = find(data.self_uid);
+    if (!slot.has_value()) {
+        if (state == PEER_SLOT_TEMP && m_temp_count >= PEER_STORE_TEMP_CAPACITY) {
+            evict_temp();
+        }
+
+        for (size_t i = 0; i < PEER_STORE_CAPACITY; i++) {
+            if (m_hot[i].state == PEER_SLOT_FREE) {
+                slot = i;
+                break;
+            }
+        }
+
+        // Mapped peers take the place of temporary ones
+        if (!slot.has_value()) {
+            slot = evict_temp();
+        }
+
+        if (!slot.has_value()) {
+            bump(m_rejected);
+            return {};
+        }
+
+        if (state == PEER_SLOT_TEMP) {
+            bump(m_temp_inserted);
+        }
+    }
+
+    size_t s = slot.value();
+    PeerHot& hot = m_hot[s];
+
+    if (hot.state == PEER_SLOT_TEMP && state != PEER_SLOT_TEMP) {
+        m_temp_count.fetch_sub(1, std::memory_order_relaxed);
+    } else if (hot.state == PEER_SLOT_FREE && state == PEER_SLOT_TEMP) {
+        m_temp_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_cold[s] = data;
+    hot.alive_stamp = alive_stamp;
+    hot.pipe_resmap = data.topo.pipe_resmap;
+    hot.uid = data.self_uid;
+    hot.type = data.type;
+    hot.ck_type = (uint8_t)data.ck_type;
+    if (hot.state != PEER_SLOT_KNOWN) {
+        hot.state = state;
+    }
+
+    // Publish the MAC before the index so a reader following the index always finds a complete entry
+    hot.mac.store(((uint64_t)data.self_uid << 48) | (data.self_address & MAC_MASK), std::memory_order_release);
+    index_insert(data.self_uid, s);
+
+    if (s + 1 > m_high_water) {
+        m_high_water = s + 1;
+    }
+
+    m_last_used[s].store(alive_stamp, std::memory_order_relaxed);
+
+    return s;
+}
+
+void PeerStore::remove(uint16_t uid) {
+    auto slot = find(uid);
+    if (!slot.has_value()) {
+        return;
+    }
+
+    size_t s = slot.value();
+    if (m_hot[s].state == PEER_SLOT_TEMP) {
+        m_temp_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    index_erase(uid);
+    m_hot[s].mac.store(0, std::memory_order_release);
+    m_hot[s].state = PEER_SLOT_FREE;
+
+    while (m_high_water > 0 && m_hot[m_high_water - 1].state == PEER_SLOT_FREE) {
+        m_high_water--;
+    }
+}
+
+void PeerStore::mark_used(uint16_t uid, uint64_t now_ms) {
+    uint16_t idx = index_find(uid, std::memory_order_relaxed);
+    if (idx != 0) {
+        m_last_used[idx - 1].store(now_ms, std::memory_order_relaxed);
+    }
+}
+
+size_t PeerStore::expire_temp(uint64_t now_ms, uint64_t ttl_ms) {
+    size_t expired = 0;
+
+    for (size_t slot = 0; slot < m_high_water; slot++) {
+        uint64_t last_used = m_last_used[slot].load(std::memory_order_relaxed);
+        if (m_hot[slot].state == PEER_SLOT_TEMP && now_ms > last_used && now_ms - last_used > ttl_ms) {
+            remove(m_hot[slot].uid);
+            bump(m_temp_expired);
+            expired++;
+        }
+    }
+
+    return expired;
+}
+
+PeerStoreStats PeerStore::stats() const {
+    PeerStoreStats stats{};
+    stats.temp_inserted = m_temp_inserted.load(std::memory_order_relaxed);
+    stats.temp_evicted = m_temp_evicted.load(std::memory_order_relaxed);
+    stats.temp_expired = m_temp_expired.load(std::memory_order_relaxed);
+    stats.temp_count = m_temp_count.load(std::memory_order_relaxed);
+    stats.rejected = m_rejected.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+std::optional<size_t> PeerStore::evict_temp() {
+    std::optional<size_t> lru;
+
+    for (size_t slot = 0; slot < m_high_water; slot++) {
+        if (m_hot[slot].state != PEER_SLOT_TEMP) {
+            continue;
+        }
+
+        if (!lru.has_value() || m_last_used[slot].load(std::memory_order_relaxed) < m_last_used[lru.value()].load(std::memory_order_relaxed)) {
+            lru = slot;
+        }
+    }
+
+    if (lru.has_value()) {
+        remove(m_hot[lru.value()].uid);
+        bump(m_temp_evicted);
+    }
+
+    return lru;
+}
+
+void PeerStore::bump(std::atomic<uint64_t> &counter) {
+    // Writes are serialized by the caller
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void PeerStore::touch(size_t slot, uint64_t alive_stamp) {
+    m_hot[slot].alive_stamp = alive_stamp;
+}
+
+void PeerStore::set_generation(size_t slot, uint32_t generation) {
+    m_cold[slot].generation = generation;
+}
+
+void PeerStore::set_topology(size_t slot, const NodeTopology &topo) {
+    m_cold[slot].topo = topo;
+    m_hot[slot].pipe_resmap = topo.pipe_resmap;
+}
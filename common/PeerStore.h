@@ -0,0 +1,201 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef PEERSTORE_H
+#define PEERSTORE_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <optional>
+
+#include "packet_structs.h"
+
+#ifndef PEER_STORE_CAPACITY
+#define PEER_STORE_CAPACITY 1024        /**< Peers stored at most, mapped and temporary. Set by OAN_PEER_STORE_CAPACITY */
+#endif // PEER_STORE_CAPACITY
+#define PEER_STORE_TEMP_CAPACITY 32     /**< Temporary peers kept at most, the least recently used is evicted */
+
+/**
+ * @enum PeerSlotState
+ * @brief State of a peer store slot
+ */
+enum PeerSlotState : uint8_t {
+    PEER_SLOT_FREE = 0,     /**< Unused slot */
+    PEER_SLOT_TEMP,         /**< Peer only known from its traffic, not mapped yet */
+    PEER_SLOT_PROVISIONAL,  /**< Peer restored from the peer cache, waiting for live traffic to confirm it */
+    PEER_SLOT_KNOWN         /**< Peer discovered by the mapper */
+};
+
+/**
+ * @struct PeerInfos
+ * @brief Stores other visible devices infos
+ */
+struct PeerInfos {
+    MappingData peer_data;  /**< Device infos */
+    uint64_t alive_stamp;   /**< Last alive message timestamp */
+};
+
+/**
+ * @struct PeerHot
+ * @brief Peer data read on the packet path and by the mapper scans. Two entries per cache line.
+ */
+struct alignas(32) PeerHot {
+    std::atomic<uint64_t> mac;  /**< UID << 48 | MAC address, 0 when the slot is free. Read wait-free */
+    uint64_t alive_stamp;       /**< Last alive message timestamp */
+    uint64_t pipe_resmap;       /**< Copy of the topology pipe resource map for placement scans */
+    uint16_t uid;               /**< Peer UID */
+    DeviceType type;            /**< Peer device type */
+    uint8_t ck_type;            /**< Peer ClockType */
+    PeerSlotState state;        /**< Slot state */
+};
+
+/**
+ * @struct PeerStoreStats
+ * @brief Peer store counters
+ */
+struct PeerStoreStats {
+    uint64_t temp_inserted;     /**< Temporary peers added */
+    uint64_t temp_evicted;      /**< Temporary peers evicted to make room */
+    uint64_t temp_expired;      /**< Temporary peers unused for longer than their TTL */
+    uint64_t temp_count;        /**< Temporary peers currently stored */
+    uint64_t rejected;          /**< Peers not stored because every slot holds a mapped peer */
+};
+
+/**
+ * @class PeerStore
+ * @brief Slot based peer storage. An open addressed UID -> slot index leads to a compact hot array (MAC, state,
+ * liveness) kept apart from the cold mapping data (name, topology). MAC lookups never block, they only retry when a
+ * removal moved index entries meanwhile. Every other access and all writes must be serialized by the caller, except
+ * mark_used and stats.
+ *
+ * Every table is sized from PEER_STORE_CAPACITY, 128 bytes per peer (index, hot, cold and LRU entries): 128 KiB for
+ * the default 1024 peers, 8 KiB for 64. The index holds twice the capacity and removals shift entries back instead of
+ * leaving tombstones, so that probes stay short as temporary peers churn.
+ *
+ * Temporary peers (known from their traffic only) are bounded to PEER_STORE_TEMP_CAPACITY entries with LRU
+ * eviction, and always give way to mapped peers when the store is full, so a UID sweep cannot fill the table.
+ */
+class PeerStore {
+public:
+    PeerStore();
+    ~PeerStore() = default;
+
+    /**
+     * Lock-free MAC lookup, safe from any thread. Retried only while a removal moves index entries
+     * @param uid UID to find
+     * @return MAC address if the peer is known or temporary
+     */
+    std::optional<uint64_t> find_mac(uint16_t uid) const;
+
+    /**
+     * Find the slot holding a peer
+     * @param uid UID to find
+     * @return Slot index if found
+     */
+    std::optional<size_t> find(uint16_t uid) const;
+
+    /**
+     * Check if a peer is stored with the given state
+     * @param uid UID to find
+     * @param state Expected slot state
+     */
+    bool contains(uint16_t uid, PeerSlotState state = PEER_SLOT_KNOWN) const;
+
+    /**
+     * Insert or update a peer. A known peer is never downgraded to temporary. Inserting a temporary peer past
+     * PEER_STORE_TEMP_CAPACITY, or any peer in a full store, evicts the least recently used temporary peer.
+     * @param data Peer mapping data
+     * @param alive_stamp Last alive timestamp
+     * @param state Slot state to store
+     * @return Slot index, empty if the store is full or the UID is 0
+     */
+    std::optional<size_t> upsert(const MappingData& data, uint64_t alive_stamp, PeerSlotState state);
+
+    /**
+     * Remove a peer
+     * @param uid UID to remove
+     */
+    void remove(uint16_t uid);
+
+    /**
+     * Record traffic from a peer, refreshing its LRU position if temporary. Lock-free, safe from any thread
+     * @param uid Peer UID
+     * @param now_ms Local monotonic time in ms
+     */
+    void mark_used(uint16_t uid, uint64_t now_ms);
+
+    /**
+     * Remove the temporary peers unused for longer than the TTL
+     * @param now_ms Local monotonic time in ms
+     * @param ttl_ms Time to live of unused temporary peers
+     * @return Number of expired peers
+     */
+    size_t expire_temp(uint64_t now_ms, uint64_t ttl_ms);
+
+    /**
+     * @return Peer store counters, safe from any thread
+     */
+    PeerStoreStats stats() const;
+
+    /**
+     * Upper bound of the used slots, scans can stop there
+     */
+    size_t high_water() const { return m_high_water; }
+
+    const PeerHot& hot(size_t slot) const { return m_hot[slot]; }
+    const MappingData& cold(size_t slot) const { return m_cold[slot]; }
+
+    /**
+     * Refresh the liveness timestamp of a stored peer
+     * @param slot Peer slot
+     * @param alive_stamp Last alive timestamp
+     */
+    void touch(size_t slot, uint64_t alive_stamp);
+
+    /**
+     * Set the topology generation of a stored peer
+     * @param slot Peer slot
+     * @param generation Generation of the stored topology
+     */
+    void set_generation(size_t slot, uint32_t generation);
+
+    /**
+     * Update the topology of a stored peer, keeping the hot copy in sync
+     * @param slot Peer slot
+     * @param topo New topology
+     */
+    void set_topology(size_t slot, const NodeTopology& topo);
+
+private:
+    static constexpr uint64_t MAC_MASK = 0xFFFFFFFFFFFFULL;
+    static constexpr size_t INDEX_SIZE = std::bit_ceil<size_t>(2 * PEER_STORE_CAPACITY);
+    static constexpr uint32_t INDEX_EMPTY = 0;
+
+    uint16_t index_find(uint16_t uid, std::memory_order order) const;
+    void index_insert(uint16_t uid, size_t slot);
+    void index_erase(uint16_t uid);
+
+    std::optional<size_t> evict_temp();
+    static void bump(std::atomic<uint64_t>& counter);
+
+    std::array<std::atomic<uint32_t>, INDEX_SIZE> m_index;      // UID << 16 | (slot + 1), linear probing
+    std::atomic<uint32_t> m_index_seq;                          // Odd while a removal shifts index entries
+    std::array<PeerHot, PEER_STORE_CAPACITY> m_hot;
+    std::array<MappingData, PEER_STORE_CAPACITY> m_cold;
+    std::array<std::atomic<uint64_t>, PEER_STORE_CAPACITY> m_last_used;   // Local ms, LRU order of temporary peers
+    size_t m_high_water;
+
+    std::atomic<uint64_t> m_temp_count;
+    std::atomic<uint64_t> m_temp_inserted;
+    std::atomic<uint64_t> m_temp_evicted;
+    std::atomic<uint64_t> m_temp_expired;
+    std::atomic<uint64_t> m_rejected;
+};
+
+
+
+#endif //PEERSTORE_H
@@ -0,0 +1,214 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "PipePlacer.h"
+
+#include <bit>
+
+PipePlacer::PipePlacer() {
+    for (auto& dsp : m_dsps) {
+        dsp.uid.store(0, std::memory_order_relaxed);
+        dsp.advertised.store(0, std::memory_order_relaxed);
+        dsp.claimed.store(0, std::memory_order_relaxed);
+    }
+
+    for (auto& a : m_affinity) {
+        a.store(0, std::memory_order_relaxed);
+    }
+}
+
+void PipePlacer::update_dsp(uint16_t uid, uint64_t pipe_resmap) {
+    if (uid == 0) {
+        return;
+    }
+
+    auto idx = find_dsp(uid);
+    if (idx.has_value()) {
+        DspLoad& dsp = m_dsps[idx.value()];
+        dsp.advertised.store(pipe_resmap, std::memory_order_release);
+
+        // Claimed pipes the DSP reports as used are now allocated on its side
+        dsp.claimed.fetch_and(pipe_resmap, std::memory_order_acq_rel);
+        return;
+    }
+
+    for (auto& dsp : m_dsps) {
+        if (dsp.uid.load(std::memory_order_acquire) == 0) {
+            dsp.claimed.store(0, std::memory_order_relaxed);
+            dsp.advertised.store(pipe_resmap, std::memory_order_relaxed);
+            dsp.uid.store(uid, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+void PipePlacer::remove_dsp(uint16_t uid) {
+    auto idx = find_dsp(uid);
+    if (!idx.has_value()) {
+        return;
+    }
+
+    DspLoad& dsp = m_dsps[idx.value()];
+    dsp.uid.store(0, std::memory_order_release);
+    dsp.advertised.store(0, std::memory_order_release);
+
+    for (auto& a : m_affinity) {
+        uint16_t expected = uid;
+        a.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+    }
+}
+
+std::optional<PipeReservation> PipePlacer::reserve(uint8_t channel, uint8_t count) {
+    if (count == 0 || count > 64) {
+        return {};
+    }
+
+    // Bounded retries, each failure means another thread claimed pipes or pinned the channel in between
+    for (int attempt = 0; attempt < PIPE_PLACER_MAX_DSP; attempt++) {
+        uint16_t pinned = m_affinity[channel].load(std::memory_order_acquire);
+
+        if (pinned != 0) {
+            // The channel already lives on a DSP, its pipes must stay there
+            auto idx = find_dsp(pinned);
+            if (!idx.has_value()) {
+                clear_affinity(channel);
+                continue;
+            }
+
+            auto pipes = try_claim(m_dsps[idx.value()], count);
+            if (!pipes.has_value()) {
+                return {};
+            }
+
+            return PipeReservation{pinned, channel, pipes.value()};
+        }
+
+        std::optional<size_t> best;
+        int best_free = count - 1;
+        for (size_t i = 0; i < PIPE_PLACER_MAX_DSP; i++) {
+            const DspLoad& dsp = m_dsps[i];
+            if (dsp.uid.load(std::memory_order_acquire) == 0) {
+                continue;
+            }
+
+            uint64_t free_map = dsp.advertised.load(std::memory_order_acquire) &
+                                ~dsp.claimed.load(std::memory_order_acquire);
+            int free_count = std::popcount(free_map);
+            if (free_count > best_free) {
+                best = i;
+                best_free = free_count;
+            }
+        }
+
+        if (!best.has_value()) {
+            return {};
+        }
+
+        DspLoad& dsp = m_dsps[best.value()];
+        uint16_t uid = dsp.uid.load(std::memory_order_acquire);
+        auto pipes = try_claim(dsp, count);
+        if (!pipes.has_value() || uid == 0) {
+            continue;
+        }
+
+        uint16_t expected = 0;
+        if (m_affinity[channel].compare_exchange_strong(expected, uid, std::memory_order_acq_rel) || expected == uid) {
+            return PipeReservation{uid, channel, pipes.value()};
+        }
+
+        // A concurrent placement pinned the channel elsewhere, follow it
+        dsp.claimed.fetch_and(~pipes.value(), std::memory_order_acq_rel);
+    }
+
+    return {};
+}
+
+void PipePlacer::release(const PipeReservation &res) {
+    auto idx = find_dsp(res.dsp_uid);
+    if (!idx.has_value()) {
+        return;
+    }
+
+    m_dsps[idx.value()].claimed.fetch_and(~res.pipes, std::memory_order_acq_rel);
+}
+
+void PipePlacer::clear_affinity(uint8_t channel) {
+    m_affinity[channel].store(0, std::memory_order_release);
+}
+
+std::optional<uint16_t> PipePlacer::least_loaded_dsp() const {
+    std::optional<uint16_t> best;
+    int best_free = 0;
+
+    for (const auto& dsp : m_dsps) {
+        uint16_t uid = dsp.uid.load(std::memory_order_acquire);
+        if (uid == 0) {
+            continue;
+        }
+
+        int free_count = std::popcount(dsp.advertised.load(std::memory_order_acquire) &
+                                       ~dsp.claimed.load(std::memory_order_acquire));
+        if (free_count > best_free) {
+            best = uid;
+            best_free = free_count;
+        }
+    }
+
+    return best;
+}
+
+uint64_t PipePlacer::free_pipes(uint16_t uid) const {
+    auto idx = find_dsp(uid);
+    if (!idx.has_value()) {
+        return 0;
+    }
+
+    const DspLoad& dsp = m_dsps[idx.value()];
+    return dsp.advertised.load(std::memory_order_acquire) & ~dsp.claimed.load(std::memory_order_acquire);
+}
+
+std::optional<size_t> PipePlacer::find_dsp(uint16_t uid) const {
+    if (uid == 0) {
+        return {};
+    }
+
+    for (size_t i = 0; i < PIPE_PLACER_MAX_DSP; i++) {
+        if (m_dsps[i].uid.load(std::memory_order_acquire) == uid) {
+            return i;
+        }
+    }
+
+    return {};
+}
+
+std::optional<uint64_t> PipePlacer::try_claim(DspLoad &dsp, uint8_t count) {
+    uint64_t claimed = dsp.claimed.load(std::memory_order_acquire);
+
+    while (true) {
+        uint64_t free_map = dsp.advertised.load(std::memory_order_acquire) & ~claimed;
+        uint64_t pipes = lowest_bits(free_map, count);
+        if (pipes == 0) {
+            return {};
+        }
+
+        if (dsp.claimed.compare_exchange_weak(claimed, claimed | pipes, std::memory_order_acq_rel)) {
+            return pipes;
+        }
+    }
+}
+
+uint64_t PipePlacer::lowest_bits(uint64_t map, uint8_t count) {
+    if (std::popcount(map) < count) {
+        return 0;
+    }
+
+    uint64_t bits = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        bits |= map & -map;
+        map &= map - 1;
+    }
+
+    return bits;
+}
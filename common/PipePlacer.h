@@ -0,0 +1,103 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef PIPEPLACER_H
+#define PIPEPLACER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#define PIPE_PLACER_MAX_DSP 64
+#define PIPE_PLACER_CHANNELS 256
+
+/**
+ * @struct PipeReservation
+ * @brief Processing pipes reserved on a DSP for a channel
+ */
+struct PipeReservation {
+    uint16_t dsp_uid;   /**< DSP holding the pipes */
+    uint8_t channel;    /**< Channel the pipes were placed for */
+    uint64_t pipes;     /**< Reserved pipes, one bit per pipe index */
+};
+
+/**
+ * @class PipePlacer
+ * @brief Load aware processing pipe placement across the DSPs of the network. Pipes resource maps have one bit per
+ * pipe, set when the pipe is free. Placement favors the DSP already holding the channel pipes, then the DSP with the
+ * most free pipes. Pipes are claimed atomically at reservation time, before the ControlPipeCreate is sent, so
+ * concurrent placements never pick the same pipe.
+ */
+class PipePlacer {
+public:
+    PipePlacer();
+    ~PipePlacer() = default;
+
+    /**
+     * Add or refresh a DSP from its advertised pipe resource map. Claimed pipes the DSP now reports as used are
+     * considered allocated and released from the claims.
+     * @param uid DSP UID
+     * @param pipe_resmap Advertised free pipes map
+     */
+    void update_dsp(uint16_t uid, uint64_t pipe_resmap);
+
+    /**
+     * Forget a DSP and the channel affinities pointing to it
+     * @param uid DSP UID
+     */
+    void remove_dsp(uint16_t uid);
+
+    /**
+     * Place and reserve pipes for a channel
+     * @param channel Channel to place
+     * @param count Number of pipes needed, all on the same DSP
+     * @return The reservation, empty if no DSP has enough free pipes
+     */
+    std::optional<PipeReservation> reserve(uint8_t channel, uint8_t count = 1);
+
+    /**
+     * Give back pipes that were not created, after a failed ControlPipeCreate transaction
+     * @param res Reservation to release
+     */
+    void release(const PipeReservation& res);
+
+    /**
+     * Drop the DSP affinity of a channel, for example when it gets deleted
+     * @param channel Channel to forget
+     */
+    void clear_affinity(uint8_t channel);
+
+    /**
+     * Get the DSP with the most free pipes
+     * @return DSP UID if any has a free pipe
+     */
+    std::optional<uint16_t> least_loaded_dsp() const;
+
+    /**
+     * Get the currently free pipes of a DSP, claims excluded
+     * @param uid DSP UID
+     */
+    uint64_t free_pipes(uint16_t uid) const;
+
+private:
+    struct DspLoad {
+        std::atomic<uint16_t> uid;          // 0 when unused
+        std::atomic<uint64_t> advertised;   // Free pipes advertised by the DSP
+        std::atomic<uint64_t> claimed;      // Pipes reserved here and not yet reported used
+    };
+
+    std::optional<size_t> find_dsp(uint16_t uid) const;
+    std::optional<uint64_t> try_claim(DspLoad& dsp, uint8_t count);
+
+    static uint64_t lowest_bits(uint64_t map, uint8_t count);
+
+    std::array<DspLoad, PIPE_PLACER_MAX_DSP> m_dsps;
+    std::array<std::atomic<uint16_t>, PIPE_PLACER_CHANNELS> m_affinity;  // Channel -> DSP UID, 0 if none
+};
+
+
+
+#endif //PIPEPLACER_H
@@ -0,0 +1,234 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "PipeTransactionEngine.h"
+
+#include "NetworkMapper.h"
+
+PipeTransactionEngine::PipeTransactionEngine(std::shared_ptr<AudioRouter> router, size_t window, uint64_t timeout_us, uint8_t max_retries) {
+    m_router = std::move(router);
+    m_window = window;
+    m_timeout_us = timeout_us;
+    m_max_retries = max_retries;
+    m_wheel = nullptr;
+    m_update_timer = 0;
+}
+
+PipeTransactionEngine::~PipeTransactionEngine() {
+    unschedule();
+}
+
+void PipeTransactionEngine::schedule_on(TimerWheel &wheel) {
+    unschedule();
+
+    m_wheel = &wheel;
+    m_update_timer = wheel.schedule(m_timeout_us / 2, [this]() {
+        update();
+    }, m_timeout_us / 2);
+}
+
+void PipeTransactionEngine::unschedule() {
+    if (m_wheel != nullptr) {
+        m_wheel->cancel(m_update_timer);
+        m_wheel = nullptr;
+    }
+}
+
+uint32_t PipeTransactionEngine::make_transaction_key(uint16_t dest_uid, uint16_t pid) {
+    return ((uint32_t)dest_uid << 16) | pid;
+}
+
+uint64_t PipeTransactionEngine::make_element_key(uint16_t dest_uid, uint16_t pid, uint8_t seq) {
+    return ((uint64_t)make_transaction_key(dest_uid, pid) << 8) | seq;
+}
+
+bool PipeTransactionEngine::begin_transaction(uint16_t dest_uid, uint8_t channel, uint16_t pid, const std::vector<std::string> &elements,
+                                              const std::function<void(const PipeTransactionResult &)> &on_complete) {
+    // seq and seq_max are 8 bits wide
+    if (elements.empty() || elements.size() > 255) {
+        return false;
+    }
+
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_engine_mutex};
+#endif // NO_THREADS
+
+    uint32_t tkey = make_transaction_key(dest_uid, pid);
+    if (m_transactions.contains(tkey)) {
+        return false;
+    }
+
+    Transaction transaction{};
+    transaction.result.dest_uid = dest_uid;
+    transaction.result.pid = pid;
+    transaction.result.channel = channel;
+    transaction.remaining = elements.size();
+    transaction.on_complete = on_complete;
+    m_transactions[tkey] = transaction;
+
+    for (size_t i = 0; i < elements.size(); i++) {
+        PendingElement elem{};
+        elem.dest_uid = dest_uid;
+        elem.packet.header.type = PacketType::CONTROL_CREATE;
+        elem.packet.header.version = OAN_PROTOCOL_VERSION;
+        elem.packet.packet_data.channel = channel;
+        elem.packet.packet_data.stack_position = i;
+        elem.packet.packet_data.seq = i;
+        elem.packet.packet_data.seq_max = elements.size();
+        elem.packet.packet_data.pid = pid;
+        strncpy(elem.packet.packet_data.elem_type, elements[i].c_str(), sizeof(elem.packet.packet_data.elem_type) - 1);
+
+        m_queued.emplace_back(elem);
+    }
+
+    fill_window(oals::tstamp::now_us());
+
+    return true;
+}
+
+std::unordered_map<uint64_t, PipeTransactionEngine::PendingElement>::iterator PipeTransactionEngine::find_acknowledged(const ControlResponsePacket &pck, uint16_t sender_uid) {
+    const ControlResponse& resp = pck.packet_data;
+    if (pck.header.version != 0) {
+        return m_in_flight.find(make_element_key(sender_uid, resp.pid, resp.seq));
+    }
+
+    // No seq in legacy responses: the oldest pending element of the pipe, at most a window to scan
+    auto oldest = m_in_flight.end();
+    for (auto it = m_in_flight.begin(); it != m_in_flight.end(); ++it) {
+        const ControlPipeCreate& data = it->second.packet.packet_data;
+        if (it->second.dest_uid == sender_uid && data.pid == resp.pid
+            && (oldest == m_in_flight.end() || data.seq < oldest->second.packet.packet_data.seq)) {
+            oldest = it;
+        }
+    }
+
+    return oldest;
+}
+
+bool PipeTransactionEngine::process_response(const ControlResponsePacket &pck, const LowLatHeader &llhdr) {
+    std::vector<Transaction> done;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_engine_mutex};
+#endif // NO_THREADS
+
+        const ControlResponse& resp = pck.packet_data;
+        auto elem = find_acknowledged(pck, llhdr.sender_uid);
+        if (elem == m_in_flight.end()) {
+            return false;
+        }
+
+        m_in_flight.erase(elem);
+
+        uint32_t tkey = make_transaction_key(llhdr.sender_uid, resp.pid);
+        auto transaction = m_transactions.find(tkey);
+        if (transaction != m_transactions.end()) {
+            if (resp.response & ControlResponseCode::CREATE_OK) {
+                transaction->second.result.response = resp.response;
+                transaction->second.remaining--;
+
+                if (transaction->second.remaining == 0) {
+                    transaction->second.result.success = true;
+                    done.emplace_back(std::move(transaction->second));
+                    m_transactions.erase(transaction);
+                }
+            } else {
+                std::string err_msg(resp.err_msg, strnlen(resp.err_msg, sizeof(resp.err_msg)));
+                fail_transaction(tkey, resp.response, err_msg, done);
+            }
+        }
+
+        fill_window(oals::tstamp::now_us());
+    }
+
+    for (auto& t : done) {
+        t.on_complete(t.result);
+    }
+
+    return true;
+}
+
+void PipeTransactionEngine::update() {
+    std::vector<Transaction> done;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_engine_mutex};
+#endif // NO_THREADS
+
+        uint64_t now = oals::tstamp::now_us();
+
+        std::vector<uint32_t> expired;
+        for (auto& [key, elem] : m_in_flight) {
+            if (now - elem.sent_at < m_timeout_us) {
+                continue;
+            }
+
+            if (elem.retries >= m_max_retries) {
+                expired.push_back(make_transaction_key(elem.dest_uid, elem.packet.packet_data.pid));
+            } else {
+                m_router->send_control_packet(elem.packet, elem.dest_uid);
+                elem.sent_at = now;
+                elem.retries++;
+            }
+        }
+
+        for (auto tkey : expired) {
+            fail_transaction(tkey, 0, "Transaction timed out", done);
+        }
+
+        fill_window(now);
+    }
+
+    for (auto& t : done) {
+        t.on_complete(t.result);
+    }
+}
+
+bool PipeTransactionEngine::idle() {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_engine_mutex};
+#endif // NO_THREADS
+
+    return m_transactions.empty();
+}
+
+void PipeTransactionEngine::fill_window(uint64_t now) {
+    while (m_in_flight.size() < m_window && !m_queued.empty()) {
+        PendingElement elem = m_queued.front();
+        m_queued.pop_front();
+
+        elem.sent_at = now;
+        m_router->send_control_packet(elem.packet, elem.dest_uid);
+
+        const ControlPipeCreate& data = elem.packet.packet_data;
+        m_in_flight[make_element_key(elem.dest_uid, data.pid, data.seq)] = elem;
+    }
+}
+
+void PipeTransactionEngine::fail_transaction(uint32_t tkey, uint8_t response, const std::string &err_msg, std::vector<Transaction>& done) {
+    auto transaction = m_transactions.find(tkey);
+    if (transaction == m_transactions.end()) {
+        return;
+    }
+
+    auto belongs = [tkey](const PendingElement& elem) {
+        return make_transaction_key(elem.dest_uid, elem.packet.packet_data.pid) == tkey;
+    };
+
+    // Drop every remaining packet of the transaction
+    std::erase_if(m_in_flight, [&belongs](const std::pair<const uint64_t, PendingElement>& pred) {
+        return belongs(pred.second);
+    });
+    std::erase_if(m_queued, belongs);
+
+    transaction->second.result.success = false;
+    transaction->second.result.response = response;
+    transaction->second.result.err_msg = err_msg;
+
+    done.emplace_back(std::move(transaction->second));
+    m_transactions.erase(transaction);
+}
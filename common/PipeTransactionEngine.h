@@ -0,0 +1,143 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef PIPETRANSACTIONENGINE_H
+#define PIPETRANSACTIONENGINE_H
+
+#ifndef NO_THREADS
+#include <mutex>
+#endif // NO_THREADS
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AudioRouter.h"
+#include "TimerWheel.h"
+
+/**
+ * @struct PipeTransactionResult
+ * @brief Outcome of a whole pipe creation transaction
+ */
+struct PipeTransactionResult {
+    uint16_t dest_uid;      /**< Device the pipe was created on */
+    uint16_t pid;           /**< Pipe ID */
+    uint8_t channel;        /**< Channel of the pipe */
+    bool success;           /**< true if every element was acknowledged with CREATE_OK */
+    uint8_t response;       /**< Last response code received, 0 if the transaction timed out */
+    std::string err_msg;    /**< Error message of the failing response, if any */
+};
+
+/**
+ * @class PipeTransactionEngine
+ * @brief Sends ControlPipeCreate packets with many of them in flight at once. Responses are matched by
+ * (sender, pid, seq) and completion is reported per transaction. Legacy devices (protocol version 0) do not send seq
+ * back, their responses acknowledge the oldest pending element of the pipe, devices handle creations in order.
+ *
+ * Retransmission is opt-in (max_retries > 0). Creation is not idempotent on devices which do not deduplicate on
+ * (pid, seq): a retransmitted packet whose acknowledgement was lost creates the element a second time. Only enable it
+ * for devices known to deduplicate, otherwise unacknowledged elements fail the transaction after timeout_us.
+ *
+ * The engine does not own the control response callback : the application forwards responses to
+ * process_response and calls update periodically to drive retransmissions.
+ */
+class PipeTransactionEngine {
+public:
+    /**
+     * Constructor
+     * @param router Router used to send the creation packets
+     * @param window Maximum number of unacknowledged creation packets
+     * @param timeout_us Time to wait for each acknowledgement in us
+     * @param max_retries Retransmission count before a transaction is declared failed, 0 to never retransmit
+     */
+    PipeTransactionEngine(std::shared_ptr<AudioRouter> router, size_t window = 32, uint64_t timeout_us = 20000, uint8_t max_retries = 0);
+    ~PipeTransactionEngine();
+
+    /**
+     * Queue the creation of a whole pipe. Elements are stacked in the given order.
+     * @param dest_uid Device to create the pipe on
+     * @param channel Channel of the pipe
+     * @param pid Pipe ID, must be unique per device among pending transactions
+     * @param elements Element type names
+     * @param on_complete Called once when the transaction succeeds or fails
+     * @return false if the transaction is invalid or already pending
+     */
+    bool begin_transaction(uint16_t dest_uid, uint8_t channel, uint16_t pid, const std::vector<std::string>& elements,
+                           const std::function<void(const PipeTransactionResult&)>& on_complete);
+
+    /**
+     * Feed a control response to the engine
+     * @param pck Received response
+     * @param llhdr Received packet addressing header
+     * @return true if the response belonged to a pending creation packet
+     */
+    bool process_response(const ControlResponsePacket& pck, const LowLatHeader& llhdr);
+
+    /**
+     * Retransmit timed out packets and fill the window with queued packets
+     */
+    void update();
+
+    /**
+     * @return true if no transaction is pending
+     */
+    bool idle();
+
+    /**
+     * Drive update from a timer wheel, twice per retransmission timeout
+     * @param wheel Timer wheel, must outlive the engine or unschedule must be called first
+     */
+    void schedule_on(TimerWheel& wheel);
+
+    /**
+     * Cancel the timer installed by schedule_on. Called by the destructor.
+     */
+    void unschedule();
+
+private:
+    struct PendingElement {
+        ControlPipeCreatePacket packet;
+        uint16_t dest_uid;
+        uint64_t sent_at;
+        uint8_t retries;
+    };
+
+    struct Transaction {
+        PipeTransactionResult result;
+        uint8_t remaining;
+        std::function<void(const PipeTransactionResult&)> on_complete;
+    };
+
+    static uint32_t make_transaction_key(uint16_t dest_uid, uint16_t pid);
+    static uint64_t make_element_key(uint16_t dest_uid, uint16_t pid, uint8_t seq);
+
+    std::unordered_map<uint64_t, PendingElement>::iterator find_acknowledged(const ControlResponsePacket& pck, uint16_t sender_uid);
+
+    void fill_window(uint64_t now);
+    void fail_transaction(uint32_t tkey, uint8_t response, const std::string& err_msg, std::vector<Transaction>& done);
+
+    std::shared_ptr<AudioRouter> m_router;
+    size_t m_window;
+    uint64_t m_timeout_us;
+    uint8_t m_max_retries;
+
+    std::deque<PendingElement> m_queued;
+    std::unordered_map<uint64_t, PendingElement> m_in_flight;
+    std::unordered_map<uint32_t, Transaction> m_transactions;
+
+    TimerWheel* m_wheel;
+    TimerId m_update_timer;
+
+#ifndef NO_THREADS
+    std::mutex m_engine_mutex;
+#endif // NO_THREADS
+};
+
+
+
+#endif //PIPETRANSACTIONENGINE_H
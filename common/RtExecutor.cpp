@@ -0,0 +1,250 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "RtExecutor.h"
+
+#include <algorithm>
+
+#include "netutils/rt.h"
+
+static constexpr uint64_t NS_PER_S = 1'000'000'000;
+
+static inline void spin_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+uint64_t RtHistogramSnapshot::percentile_ns(double ratio) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, ratio * count);
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < RT_HISTOGRAM_BUCKETS - 1; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return std::min<uint64_t>((i + 1) * RT_HISTOGRAM_BUCKET_NS, max_ns);
+        }
+    }
+
+    return max_ns;
+}
+
+RtHistogram::RtHistogram() {
+    reset();
+}
+
+void RtHistogram::record(uint64_t value_ns) {
+    // Single writer: plain load/store pairs, no locked instruction on the RT path
+    size_t bucket = std::min<uint64_t>(value_ns / RT_HISTOGRAM_BUCKET_NS, RT_HISTOGRAM_BUCKETS - 1);
+    m_buckets[bucket].store(m_buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_sum.store(m_sum.load(std::memory_order_relaxed) + value_ns, std::memory_order_relaxed);
+
+    if (value_ns < m_min.load(std::memory_order_relaxed)) {
+        m_min.store(value_ns, std::memory_order_relaxed);
+    }
+
+    if (value_ns > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(value_ns, std::memory_order_relaxed);
+    }
+
+    m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+RtHistogramSnapshot RtHistogram::snapshot() const {
+    RtHistogramSnapshot snap{};
+    snap.count = m_count.load(std::memory_order_acquire);
+    snap.min_ns = snap.count == 0 ? 0 : m_min.load(std::memory_order_relaxed);
+    snap.max_ns = m_max.load(std::memory_order_relaxed);
+    snap.sum_ns = m_sum.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < RT_HISTOGRAM_BUCKETS; i++) {
+        snap.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    return snap;
+}
+
+void RtHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    m_count.store(0, std::memory_order_relaxed);
+    m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+}
+
+RtExecutor::RtExecutor(const RtExecutorConfig &config, const std::function<void(uint64_t, uint64_t)> &task) {
+    m_config = config;
+    m_task = task;
+    m_origin_ns = 0;
+    m_cycle = 0;
+
+    m_cycles = 0;
+    m_overruns = 0;
+    m_missed_periods = 0;
+    m_policy = RT_POLICY_NONE;
+    m_memory_locked = false;
+
+#ifndef NO_THREADS
+    m_running = false;
+#endif // NO_THREADS
+}
+
+RtExecutor::~RtExecutor() {
+#ifndef NO_THREADS
+    stop();
+#endif // NO_THREADS
+}
+
+RtExecutorConfig RtExecutor::make_config(SamplingRate rate, uint32_t frames_per_cycle) {
+    RtExecutorConfig config{};
+    config.frames_per_cycle = frames_per_cycle;
+    config.sample_rate_hz = rate == SamplingRate::SAMPLING_96K ? 96000 : 48000;
+    config.policy = RT_POLICY_DEADLINE;
+    config.fifo_priority = 80;
+    config.runtime_ns = (uint64_t)frames_per_cycle * NS_PER_S / config.sample_rate_hz / 2;
+    config.cpu = -1;
+    config.spin_ns = 50'000;
+    config.lock_memory = true;
+    config.heap_prefault_bytes = 8 << 20;
+    config.stack_prefault_bytes = 256 << 10;
+
+    return config;
+}
+
+uint64_t RtExecutor::period_start(uint64_t cycle) const {
+    // Split on whole seconds so that the product never overflows and the fractional period never accumulates
+    uint64_t seconds = cycle / m_config.sample_rate_hz;
+    uint64_t remainder = cycle % m_config.sample_rate_hz;
+
+    return m_origin_ns + seconds * m_config.frames_per_cycle * NS_PER_S
+           + remainder * m_config.frames_per_cycle * NS_PER_S / m_config.sample_rate_hz;
+}
+
+void RtExecutor::run_cycle() {
+    if (m_origin_ns == 0) {
+        m_origin_ns = oals::rt::monotonic_ns() + period_start(1);
+        m_cycle = 0;
+    }
+
+    uint64_t start = period_start(m_cycle);
+
+    if (start > m_config.spin_ns) {
+        oals::rt::sleep_until(start - m_config.spin_ns);
+    }
+
+    uint64_t now = oals::rt::monotonic_ns();
+    while (now < start) {
+        spin_pause();
+        now = oals::rt::monotonic_ns();
+    }
+
+    m_task(m_cycle, start);
+
+    uint64_t end = oals::rt::monotonic_ns();
+    m_wakeup_latency.record(now - start);
+    m_execution.record(end - now);
+
+    uint64_t next = m_cycle + 1;
+    if (end > period_start(next)) {
+        m_overrun.record(end - period_start(next));
+        m_overruns.store(m_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        // Resume on the first period not started yet rather than running late cycles back to back
+        uint64_t first = next;
+        while (period_start(next) < end) {
+            next++;
+        }
+        m_missed_periods.store(m_missed_periods.load(std::memory_order_relaxed) + next - first, std::memory_order_relaxed);
+    }
+
+    m_cycle = next;
+    m_cycles.store(m_cycles.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void RtExecutor::apply_scheduling() {
+    RtPolicy policy = m_config.policy;
+
+    if (policy == RT_POLICY_DEADLINE) {
+        // Deadline tasks may not be pinned, the reservation is what bounds their latency
+        uint64_t period = m_config.frames_per_cycle * NS_PER_S / m_config.sample_rate_hz;
+        if (!oals::rt::set_thread_deadline(m_config.runtime_ns, period, period)) {
+            policy = RT_POLICY_FIFO;
+        }
+    }
+
+    if (policy != RT_POLICY_DEADLINE && m_config.cpu >= 0) {
+        oals::rt::set_running_cpu(m_config.cpu);
+    }
+
+    if (policy == RT_POLICY_FIFO) {
+        oals::rt::set_thread_realtime(m_config.fifo_priority);
+    }
+
+    m_policy = policy;
+}
+
+#ifndef NO_THREADS
+void RtExecutor::launch() {
+    if (m_running) {
+        return;
+    }
+
+    // Process wide, done before the thread exists so that its stack is locked as it is mapped
+    if (m_config.lock_memory) {
+        m_memory_locked = oals::rt::lock_memory(m_config.heap_prefault_bytes);
+    }
+
+    m_running = true;
+    m_worker = std::thread([this]() {
+        oals::rt::prefault_stack(m_config.stack_prefault_bytes);
+        apply_scheduling();
+
+        m_origin_ns = 0;
+        while (m_running.load(std::memory_order_relaxed)) {
+            run_cycle();
+        }
+    });
+}
+
+void RtExecutor::stop() {
+    m_running = false;
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+#endif // NO_THREADS
+
+RtExecutorStats RtExecutor::stats() const {
+    RtExecutorStats stats{};
+    stats.cycles = m_cycles.load(std::memory_order_relaxed);
+    stats.overruns = m_overruns.load(std::memory_order_relaxed);
+    stats.missed_periods = m_missed_periods.load(std::memory_order_relaxed);
+    stats.policy = m_policy.load();
+    stats.memory_locked = m_memory_locked.load();
+    stats.wakeup_latency = m_wakeup_latency.snapshot();
+    stats.execution = m_execution.snapshot();
+    stats.overrun = m_overrun.snapshot();
+
+    return stats;
+}
+
+void RtExecutor::reset_stats() {
+    m_cycles = 0;
+    m_overruns = 0;
+    m_missed_periods = 0;
+    m_wakeup_latency.reset();
+    m_execution.reset();
+    m_overrun.reset();
+}
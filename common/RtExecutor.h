@@ -0,0 +1,187 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef RTEXECUTOR_H
+#define RTEXECUTOR_H
+
+#ifndef NO_THREADS
+#include <thread>
+#endif // NO_THREADS
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "audio_conf.h"
+
+#define RT_HISTOGRAM_BUCKET_NS 2000     /**< Histogram resolution */
+#define RT_HISTOGRAM_BUCKETS 1024       /**< Buckets, the last one also counts every larger value */
+
+/**
+ * @enum RtPolicy
+ * @brief Scheduling policy of the executor thread
+ */
+enum RtPolicy : uint8_t {
+    RT_POLICY_NONE = 0,     /**< Default scheduler, for tests and unprivileged runs */
+    RT_POLICY_FIFO,         /**< SCHED_FIFO at the configured priority */
+    RT_POLICY_DEADLINE      /**< SCHED_DEADLINE reservation of runtime_ns per period, falls back to FIFO if refused */
+};
+
+/**
+ * @struct RtExecutorConfig
+ * @brief Executor settings, see RtExecutor::make_config for defaults
+ */
+struct RtExecutorConfig {
+    uint32_t frames_per_cycle;      /**< Samples processed per cycle */
+    uint32_t sample_rate_hz;        /**< Sample rate, the period is frames_per_cycle / sample_rate_hz */
+    RtPolicy policy;                /**< Requested scheduling policy */
+    uint8_t fifo_priority;          /**< SCHED_FIFO priority, also used by the DEADLINE fallback */
+    uint64_t runtime_ns;            /**< SCHED_DEADLINE budget per period, must cover spin_ns and the task */
+    int cpu;                        /**< CPU to pin the thread to, -1 for none. Ignored under SCHED_DEADLINE */
+    uint64_t spin_ns;               /**< Wake up this early and busy wait the rest, absorbs the wakeup jitter */
+    bool lock_memory;               /**< mlockall the process when launching */
+    size_t heap_prefault_bytes;     /**< Heap touched ahead of time when locking memory */
+    size_t stack_prefault_bytes;    /**< Thread stack touched before the first cycle */
+};
+
+/**
+ * @struct RtHistogramSnapshot
+ * @brief Copy of a duration histogram
+ */
+struct RtHistogramSnapshot {
+    uint64_t count;                                     /**< Recorded values */
+    uint64_t min_ns;                                    /**< Smallest value */
+    uint64_t max_ns;                                    /**< Largest value */
+    uint64_t sum_ns;                                    /**< Sum of the values */
+    std::array<uint64_t, RT_HISTOGRAM_BUCKETS> buckets; /**< Bucket i counts values in [i, i + 1) * RT_HISTOGRAM_BUCKET_NS */
+
+    /**
+     * @param ratio Percentile in [0, 1]
+     * @return Upper bound of the bucket holding the percentile, max_ns if it is the overflow bucket
+     */
+    uint64_t percentile_ns(double ratio) const;
+};
+
+/**
+ * @class RtHistogram
+ * @brief Fixed bucket duration histogram, written by a single thread without locks or allocations and readable
+ * from any thread
+ */
+class RtHistogram {
+public:
+    RtHistogram();
+
+    void record(uint64_t value_ns);
+    RtHistogramSnapshot snapshot() const;
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, RT_HISTOGRAM_BUCKETS> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+    std::atomic<uint64_t> m_sum;
+};
+
+/**
+ * @struct RtExecutorStats
+ * @brief Timing of the executor cycles
+ */
+struct RtExecutorStats {
+    uint64_t cycles;                    /**< Cycles run */
+    uint64_t overruns;                  /**< Cycles which ended after the start of the next one */
+    uint64_t missed_periods;            /**< Periods skipped to catch up after overruns */
+    RtPolicy policy;                    /**< Policy actually in effect */
+    bool memory_locked;                 /**< mlockall succeeded */
+    RtHistogramSnapshot wakeup_latency; /**< Task start minus period start */
+    RtHistogramSnapshot execution;      /**< Task duration */
+    RtHistogramSnapshot overrun;        /**< Task end minus next period start, overrunning cycles only */
+};
+
+/**
+ * @class RtExecutor
+ * @brief Runs a periodic task at the audio packet period on a real time thread. The thread sleeps with
+ * clock_nanosleep(TIMER_ABSTIME) until spin_ns before each period start, then busy waits the rest: absolute deadlines
+ * keep the period exact whatever the task duration, and the spin phase hides the scheduler wakeup latency. Period
+ * starts are computed from the cycle count as a rational number of ns, a 48 kHz / 64 frames period does not drift.
+ *
+ * Memory is locked and the stack and heap are prefaulted before the first cycle. After an overrun the missed periods
+ * are skipped rather than run back to back, the task is given the cycle index and can tell.
+ *
+ * Either launch the executor thread, or call run_cycle from the host loop in NO_THREADS builds.
+ */
+class RtExecutor {
+public:
+    /**
+     * Constructor
+     * @param config Executor settings
+     * @param task Called once per cycle with the cycle index and the period start in CLOCK_MONOTONIC ns
+     */
+    RtExecutor(const RtExecutorConfig& config, const std::function<void(uint64_t, uint64_t)>& task);
+    ~RtExecutor();
+
+    /**
+     * Default settings for a packet period: SCHED_DEADLINE with half the period as budget, 50us spin, memory locked
+     * @param rate Sample rate
+     * @param frames_per_cycle Samples per cycle
+     */
+    static RtExecutorConfig make_config(SamplingRate rate, uint32_t frames_per_cycle);
+
+    /**
+     * Wait for the next period start and run the task once. Applies no scheduling setting.
+     */
+    void run_cycle();
+
+#ifndef NO_THREADS
+    /**
+     * Lock memory, then launch the executor thread and apply the scheduling settings to it
+     */
+    void launch();
+
+    /**
+     * Stop and join the executor thread, after the running cycle
+     */
+    void stop();
+#endif // NO_THREADS
+
+    /**
+     * @return Cycle timing, safe from any thread
+     */
+    RtExecutorStats stats() const;
+
+    /**
+     * Clear the counters and histograms
+     */
+    void reset_stats();
+
+private:
+    uint64_t period_start(uint64_t cycle) const;
+    void apply_scheduling();
+
+    RtExecutorConfig m_config;
+    std::function<void(uint64_t, uint64_t)> m_task;
+
+    uint64_t m_origin_ns;
+    uint64_t m_cycle;
+
+    std::atomic<uint64_t> m_cycles;
+    std::atomic<uint64_t> m_overruns;
+    std::atomic<uint64_t> m_missed_periods;
+    std::atomic<RtPolicy> m_policy;
+    std::atomic<bool> m_memory_locked;
+    RtHistogram m_wakeup_latency;
+    RtHistogram m_execution;
+    RtHistogram m_overrun;
+
+#ifndef NO_THREADS
+    std::thread m_worker;
+    std::atomic<bool> m_running;
+#endif // NO_THREADS
+};
+
+
+
+#endif //RTEXECUTOR_H
@@ -0,0 +1,290 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+#include "netutils/tstamp.h"
+
+static constexpr uint64_t SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+
+TimerWheel::TimerWheel(uint64_t tick_us) {
+    m_tick_us = std::max<uint64_t>(tick_us, 1);
+    m_current_tick = oals::tstamp::now_us() / m_tick_us;
+    m_next_id = 0;
+    m_active_timer = 0;
+
+#ifndef NO_THREADS
+    m_running = false;
+#endif // NO_THREADS
+}
+
+TimerWheel::~TimerWheel() {
+#ifndef NO_THREADS
+    stop();
+#endif // NO_THREADS
+}
+
+TimerId TimerWheel::schedule(uint64_t delay_us, const std::function<void()> &callback, uint64_t period_us) {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_wheel_mutex};
+#endif // NO_THREADS
+
+    TimerId id = ++m_next_id;
+
+    // Rounded up, a timer never fires early
+    uint64_t delay_ticks = std::max<uint64_t>((delay_us + m_tick_us - 1) / m_tick_us, 1);
+    uint64_t period_ticks = period_us == 0 ? 0 : std::max<uint64_t>((period_us + m_tick_us - 1) / m_tick_us, 1);
+
+    // The wheel may lag behind when it was not advanced for a while, delays count from now
+    uint64_t now_tick = oals::tstamp::now_us() / m_tick_us;
+    if (m_timers.empty()) {
+        m_current_tick = std::max(m_current_tick, now_tick);
+    }
+
+    uint64_t deadline_tick = std::max(m_current_tick, now_tick) + delay_ticks;
+    m_timers[id] = Timer{deadline_tick, period_ticks, callback};
+    insert(id, deadline_tick);
+
+#ifndef NO_THREADS
+    m_wakeup.notify_all();
+#endif // NO_THREADS
+
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+#ifndef NO_THREADS
+    std::unique_lock<std::mutex> m{m_wheel_mutex};
+#endif // NO_THREADS
+
+    // Wheel slots are cleaned lazily, entries without a timer are skipped
+    bool found = m_timers.erase(id) > 0;
+
+#ifndef NO_THREADS
+    // The caller may free what the callback uses as soon as cancel returns
+    m_callback_done.wait(m, [this, id]() {
+        return m_active_timer != id || m_active_thread == std::this_thread::get_id();
+    });
+#endif // NO_THREADS
+
+    return found;
+}
+
+void TimerWheel::advance(uint64_t now_us) {
+    std::vector<TimerId> expired;
+
+    {
+#ifndef NO_THREADS
+        std::lock_guard<std::mutex> m{m_wheel_mutex};
+#endif // NO_THREADS
+
+        uint64_t target = now_us / m_tick_us;
+        if (m_timers.empty() && target > m_current_tick) {
+            m_current_tick = target;
+        }
+
+        while (m_current_tick < target) {
+            m_current_tick++;
+
+            // Cascade from the highest wrapped level down, so that timers moved down are not missed
+            size_t wrapped = 0;
+            for (size_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+                if ((m_current_tick & ((1ULL << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0) {
+                    break;
+                }
+                wrapped = level;
+            }
+
+            for (size_t level = wrapped; level > 0; level--) {
+                cascade(level);
+            }
+
+            std::vector<TimerId> slot;
+            slot.swap(m_wheel[0][m_current_tick & SLOT_MASK]);
+
+            for (TimerId id : slot) {
+                auto it = m_timers.find(id);
+                if (it == m_timers.end()) {
+                    continue;
+                }
+
+                Timer& timer = it->second;
+                if (timer.deadline_tick > m_current_tick) {
+                    insert(id, timer.deadline_tick);
+                    continue;
+                }
+
+                expired.push_back(id);
+
+                if (timer.period_ticks != 0) {
+                    // Periods missed while the wheel was not advanced are coalesced into this single call
+                    timer.deadline_tick = std::max(timer.deadline_tick + timer.period_ticks, target + 1);
+                    insert(id, timer.deadline_tick);
+                }
+            }
+        }
+    }
+
+    for (TimerId id : expired) {
+        std::function<void()> callback;
+
+        {
+#ifndef NO_THREADS
+            std::lock_guard<std::mutex> m{m_wheel_mutex};
+#endif // NO_THREADS
+            auto it = m_timers.find(id);
+            if (it == m_timers.end()) {
+                continue;
+            }
+
+            callback = it->second.callback;
+            if (it->second.period_ticks == 0) {
+                m_timers.erase(it);
+            }
+
+            m_active_timer = id;
+#ifndef NO_THREADS
+            m_active_thread = std::this_thread::get_id();
+#endif // NO_THREADS
+        }
+
+        callback();
+
+        {
+#ifndef NO_THREADS
+            std::lock_guard<std::mutex> m{m_wheel_mutex};
+#endif // NO_THREADS
+            m_active_timer = 0;
+        }
+
+#ifndef NO_THREADS
+        m_callback_done.notify_all();
+#endif // NO_THREADS
+    }
+}
+
+std::optional<uint64_t> TimerWheel::next_deadline() const {
+#ifndef NO_THREADS
+    std::lock_guard<std::mutex> m{m_wheel_mutex};
+#endif // NO_THREADS
+    return next_deadline_locked();
+}
+
+std::optional<uint64_t> TimerWheel::next_deadline_locked() const {
+    std::optional<uint64_t> next;
+
+    // The first slot holding a live timer on each level, in the order the wheel reaches them. A level 0 slot is
+    // reached on its deadline, a higher one when it cascades, which bounds the deadlines it holds from below.
+    for (size_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        size_t shift = TIMER_WHEEL_SLOT_BITS * level;
+        uint64_t block = m_current_tick >> shift;
+
+        // Slots of higher levels are reached later, nothing there can beat what was found
+        if (next.has_value() && ((block + 1) << shift) >= next.value()) {
+            break;
+        }
+
+        // The current slot was already handled, it is reached again after a full turn
+        for (uint64_t offset = 1; offset <= TIMER_WHEEL_SLOTS; offset++) {
+            const std::vector<TimerId>& slot = m_wheel[level][(block + offset) & SLOT_MASK];
+            bool live = std::any_of(slot.begin(), slot.end(), [this](TimerId id) {
+                return m_timers.contains(id);
+            });
+
+            if (live) {
+                uint64_t reached = (block + offset) << shift;
+                if (!next.has_value() || reached < next.value()) {
+                    next = reached;
+                }
+                break;
+            }
+        }
+    }
+
+    if (!next.has_value()) {
+        return {};
+    }
+
+    return next.value() * m_tick_us;
+}
+
+void TimerWheel::insert(TimerId id, uint64_t deadline_tick) {
+    uint64_t delta = deadline_tick > m_current_tick ? deadline_tick - m_current_tick : 0;
+
+    for (size_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        if (delta < (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+            m_wheel[level][(deadline_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK].push_back(id);
+            return;
+        }
+    }
+
+    // Beyond the wheel range, parked in the farthest slot and re-inserted when it cascades
+    constexpr size_t top = TIMER_WHEEL_LEVELS - 1;
+    uint64_t horizon = m_current_tick + (1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    m_wheel[top][(horizon >> (TIMER_WHEEL_SLOT_BITS * top)) & SLOT_MASK].push_back(id);
+}
+
+void TimerWheel::cascade(size_t level) {
+    std::vector<TimerId> slot;
+    slot.swap(m_wheel[level][(m_current_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK]);
+
+    for (TimerId id : slot) {
+        auto it = m_timers.find(id);
+        if (it != m_timers.end()) {
+            insert(id, it->second.deadline_tick);
+        }
+    }
+}
+
+#ifndef NO_THREADS
+void TimerWheel::launch() {
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_thread = std::thread([this]() {
+        run();
+    });
+}
+
+void TimerWheel::stop() {
+    {
+        std::lock_guard<std::mutex> m{m_wheel_mutex};
+        m_running = false;
+    }
+    m_wakeup.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void TimerWheel::run() {
+    std::unique_lock<std::mutex> m{m_wheel_mutex};
+
+    while (m_running) {
+        uint64_t now = oals::tstamp::now_us();
+        auto next = next_deadline_locked();
+
+        if (!next.has_value()) {
+            m_wakeup.wait(m);
+            continue;
+        }
+
+        if (next.value() > now) {
+            // Woken early by schedule or stop, the deadline is recomputed
+            m_wakeup.wait_for(m, std::chrono::microseconds(next.value() - now));
+            continue;
+        }
+
+        m.unlock();
+        advance(now);
+        m.lock();
+    }
+}
+#endif // NO_THREADS
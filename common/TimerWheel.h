@@ -0,0 +1,120 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#ifndef NO_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif // NO_THREADS
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+
+typedef uint64_t TimerId;
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timer wheel driving the periodic work of the stack (announcements, liveness checks, clock sync
+ * rounds, control timeouts). TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots, timers cascade down a level
+ * each time the level below wraps, so scheduling and expiry are O(1) whatever the number of timers.
+ *
+ * Either launch the wheel thread, which sleeps until the next deadline, or call advance from the host loop in
+ * NO_THREADS builds. Callbacks run without the wheel lock held and may schedule or cancel timers.
+ */
+class TimerWheel {
+public:
+    /**
+     * Constructor
+     * @param tick_us Wheel resolution in us
+     */
+    TimerWheel(uint64_t tick_us = 1000);
+    ~TimerWheel();
+
+    /**
+     * Schedule a callback
+     * @param delay_us Delay before the first call
+     * @param callback Callback to run
+     * @param period_us Repeat period, 0 for a one shot timer
+     * @return Timer ID, used to cancel it
+     */
+    TimerId schedule(uint64_t delay_us, const std::function<void()>& callback, uint64_t period_us = 0);
+
+    /**
+     * Cancel a timer. A periodic timer whose callback is running will not be rescheduled.
+     * @param id Timer to cancel
+     * @return false if the timer already expired or was cancelled
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * Run every timer expired at the given time
+     * @param now_us Current local monotonic time in us
+     */
+    void advance(uint64_t now_us);
+
+    /**
+     * Found from the first occupied slot of each level, without visiting every timer
+     * @return Next time the wheel has work, in local monotonic us: the closest deadline, or earlier when a timer
+     * must first cascade down a level. Empty if no timer is pending
+     */
+    std::optional<uint64_t> next_deadline() const;
+
+#ifndef NO_THREADS
+    /**
+     * Launch the wheel thread
+     */
+    void launch();
+
+    /**
+     * Stop and join the wheel thread. Pending timers are kept.
+     */
+    void stop();
+#endif // NO_THREADS
+
+private:
+    struct Timer {
+        uint64_t deadline_tick;
+        uint64_t period_ticks;
+        std::function<void()> callback;
+    };
+
+    void insert(TimerId id, uint64_t deadline_tick);
+    void cascade(size_t level);
+    std::optional<uint64_t> next_deadline_locked() const;
+    void run();
+
+    uint64_t m_tick_us;
+    uint64_t m_current_tick;
+    TimerId m_next_id;
+
+    std::unordered_map<TimerId, Timer> m_timers;
+    TimerId m_active_timer;     // Timer whose callback is running, 0 if none
+    std::array<std::array<std::vector<TimerId>, TIMER_WHEEL_SLOTS>, TIMER_WHEEL_LEVELS> m_wheel;
+
+#ifndef NO_THREADS
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::thread::id m_active_thread;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_callback_done;
+    mutable std::mutex m_wheel_mutex;
+#endif // NO_THREADS
+};
+
+
+
+#endif //TIMERWHEEL_H
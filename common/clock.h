@@ -12,7 +12,13 @@ enum ClockSyncState : uint8_t {
     CKSYNC_NO_SYNC,
     CKSYNC_SYNC,
     CKSYNC_DELAY_REQ,
-    CKSYNC_DELAY_RESP
+    CKSYNC_DELAY_RESP,
+    CKSYNC_ANNOUNCE,    /**< Broadcast by the active clock master every sync interval */
+    CKSYNC_FOLLOW_UP    /**< Carries the precise transmit time of the previous two-step SYNC */
+};
+
+enum ClockSyncFlags : uint8_t {
+    CKSYNC_FLAG_TWO_STEP = 1 << 0   /**< SYNC timestamp is coarse, the precise one comes in a FOLLOW_UP */
 };
 
 #endif //CLOCK_H
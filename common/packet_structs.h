@@ -14,6 +14,9 @@
 #include "audio_conf.h"
 
 #define AUDIO_DATA_SAMPLES_PER_PACKETS 64
+#define CONTROL_BATCH_MAX_ENTRIES 48
+#define CONTROL_STATE_CHUNK_BYTES 1136
+#define OAN_PROTOCOL_VERSION 1
 
 /**
  * @enum PacketType
@@ -26,7 +29,11 @@ enum class PacketType : uint32_t {
     CONTROL_RESPONSE,   /**< Response to a control command */
     CONTROL_QUERY,      /**< Device request */
     AUDIO,              /**< Audio data packets */
-    CLOCK_SYNC          /**< Time sync between devices */
+    CLOCK_SYNC,         /**< Time sync between devices */
+    CONTROL_BATCH,      /**< Several show control values applied at once */
+    HEARTBEAT,          /**< Small liveness message sent between mapping announcements */
+    MAPPING_DELTA,      /**< Immediate topology change announcement @see MappingDelta */
+    CONTROL_STATE       /**< Part of a control state snapshot @see ControlStateChunk */
 };
 
 /**
@@ -58,6 +65,7 @@ enum class ControlQueryType : uint32_t {
     PHY_OUT_MAP,        /**< Get the map of free physical out in the device */
     PIPES_MAP,          /**< Get the map of free processing pipes in the device */
     PIPE_ALLOC_RESET,   /**< Reset pipes and channel allocator in device */
+    CONTROL_STATE_SYNC, /**< Get the control values changed after the version given in flags, 0 for all of them */
 };
 
 /**
@@ -116,9 +124,9 @@ struct NodeTopology {
  */
 struct CommonHeader {
     PacketType type;        /**< Encapsulated packet type */
-    uint16_t version;       /**< Protocol version */
+    uint16_t version;       /**< Protocol version, OAN_PROTOCOL_VERSION. 0 for legacy senders */
     uint16_t flags;         /**< Header flags (currently unused) */
-    uint64_t timestamp;     /**< Packet timestamp, used only for audio packets */
+    uint64_t timestamp;     /**< Packet timestamp. For audio packets, network time in us at which the first sample plays @see MediaClock */
     uint64_t prev_delay;    /**< Previous accumulated delay in us */
 } __attribute__((packed));
 
@@ -145,6 +153,31 @@ struct MappingData {
     SamplingRate sample_rate;  /**< Device sample rate (IO & DSP only) */
     NodeTopology topo;         /**< Device physical and compute topology */
     ClockType ck_type;         /**< Device clock type */
+    uint32_t generation;       /**< Topology generation, incremented on each resource change @see MappingDelta */
+};
+
+/**
+ * @struct MappingDelta
+ * @brief Topology change sent as soon as it happens, instead of waiting for the next full MappingData announcement.
+ * Receivers only apply generations newer than the one they know.
+ */
+struct MappingDelta {
+    uint16_t self_uid;      /**< Device UID */
+    uint16_t __padding__;
+    uint32_t generation;    /**< Topology generation */
+    NodeTopology topo;      /**< New device topology */
+};
+
+/**
+ * @struct Heartbeat
+ * @brief Liveness message, sent much more often than the full MappingData
+ */
+struct Heartbeat {
+    uint16_t self_uid;      /**< Device UID */
+    uint16_t seq;           /**< Heartbeat sequence number */
+    uint16_t interval_ms;   /**< Heartbeat interval of the sender */
+    uint16_t __padding__;
+    uint32_t view_digest;   /**< Digest of the peers known by the sender and their generations, itself included */
 };
 
 /**
@@ -173,6 +206,33 @@ struct ControlData {
     uint32_t data[4];         /**< Control data */
 };
 
+/**
+ * @struct ControlBatch
+ * @brief Several pipe control values sent in a single frame. The receiver applies the whole batch at once.
+ */
+struct ControlBatch {
+    uint8_t count;                                      /**< Valid entries count */
+    uint8_t __padding__[3];
+    ControlData entries[CONTROL_BATCH_MAX_ENTRIES];     /**< Control values, only the first count entries are valid */
+};
+
+/**
+ * @struct ControlStateChunk
+ * @brief Part of a control state snapshot, answer to a CONTROL_STATE_SYNC query. Entries are sorted by control and
+ * delta encoded: key delta from the previous entry of the chunk (LEB128), data type, then 1, 2, 4 or 16 bytes of
+ * value depending on the type. Each chunk decodes on its own. @see ControlStateCache
+ */
+struct ControlStateChunk {
+    uint32_t version;                           /**< State version of the sender when the snapshot was taken */
+    uint32_t since;                             /**< The snapshot holds the controls changed after this version */
+    uint16_t seq;                               /**< Chunk index in the snapshot */
+    uint16_t count;                             /**< Entries encoded in this chunk */
+    uint16_t size;                              /**< Valid bytes in data */
+    uint8_t last;                               /**< 1 on the last chunk of the snapshot */
+    uint8_t full;                               /**< 1 if the snapshot holds every control, the others were removed */
+    uint8_t data[CONTROL_STATE_CHUNK_BYTES];    /**< Encoded entries */
+};
+
 /**
  * @struct ControlResponse
  * @brief Error management in control frames. Especially for pipe creation.
@@ -182,6 +242,7 @@ struct ControlResponse {
     uint8_t channel;              /**< Channel affected */
     uint16_t pid;                 /**< Pipe/Transaction ID */
     char err_msg[64];             /**< Error message */
+    uint8_t seq;                  /**< Sequence number of the acknowledged ControlPipeCreate packet. Absent from legacy (version 0) responses */
 };
 
 /**
@@ -192,6 +253,7 @@ struct ControlQuery {
     ControlQueryType qtype;     /**< Type of the query */
     uint32_t flags;             /**< Additional flags */
     uint32_t response[4];       /**< Device response */
+    uint32_t transaction_id;    /**< Requester transaction, echoed unchanged in the response. 0 when untracked */
 };
 
 /**
@@ -209,15 +271,24 @@ struct AudioData {
  * @brief As the timestamp is already contained in the packet header we only have to notify the clock sync state (PTP states)
  */
 struct ClockSync {
-    uint8_t packet_state;
+    uint8_t packet_state;   /**< ClockSyncState */
+    uint8_t flags;          /**< ClockSyncFlags */
+    uint16_t seq_id;        /**< Exchange sequence number, echoed in DELAY_REQ and DELAY_RESP */
+    int32_t report_offset_ns;       /**< DELAY_REQ only : slave last filtered phase error */
+    int32_t report_delay_ns;        /**< DELAY_REQ only : slave last path delay */
+    int32_t report_freq_error_ppb;  /**< DELAY_REQ only : slave frequency error against the master */
 };
 
 typedef OANPacket<MappingData> MappingPacket;                   /**< Full OAN Packet for mapping data */
 typedef OANPacket<AudioData> AudioPacket;                       /**< Full OAN Packet for audio data */
 typedef OANPacket<ControlData> ControlPacket;                   /**< Full OAN Packet for control data */
+typedef OANPacket<ControlBatch> ControlBatchPacket;             /**< Full OAN Packet for batched control data */
 typedef OANPacket<ControlPipeCreate> ControlPipeCreatePacket;   /**< Full OAN Packet for pipe creation */
 typedef OANPacket<ControlResponse> ControlResponsePacket;       /**< Full OAN Packet for control response */
 typedef OANPacket<ControlQuery> ControlQueryPacket;             /**< Full OAN Packet for control query */
 typedef OANPacket<ClockSync> ClockSyncPacket;                   /**< Full OAN Packet for clock synchronization between devices */
+typedef OANPacket<Heartbeat> HeartbeatPacket;                   /**< Full OAN Packet for peer liveness */
+typedef OANPacket<MappingDelta> MappingDeltaPacket;             /**< Full OAN Packet for topology changes */
+typedef OANPacket<ControlStateChunk> ControlStateChunkPacket;   /**< Full OAN Packet for control state snapshots */
 
 #endif //OPENAUDIONETWORK_PACKET_STRUCTS_H
@@ -0,0 +1,177 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef OPENAUDIONETWORK_PACKET_VIEW_H
+#define OPENAUDIONETWORK_PACKET_VIEW_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "netutils/lls_common.h"
+#include "packet_structs.h"
+
+/**
+ * @struct PacketTypeOf
+ * @brief Maps an encapsulated data type to its PacketType
+ * @tparam T Encapsulated data type
+ */
+template<class T>
+struct PacketTypeOf;
+
+template<> struct PacketTypeOf<MappingData> { static constexpr PacketType value = PacketType::MAPPING; };
+template<> struct PacketTypeOf<ControlData> { static constexpr PacketType value = PacketType::CONTROL; };
+template<> struct PacketTypeOf<ControlPipeCreate> { static constexpr PacketType value = PacketType::CONTROL_CREATE; };
+template<> struct PacketTypeOf<ControlResponse> { static constexpr PacketType value = PacketType::CONTROL_RESPONSE; };
+template<> struct PacketTypeOf<ControlQuery> { static constexpr PacketType value = PacketType::CONTROL_QUERY; };
+template<> struct PacketTypeOf<AudioData> { static constexpr PacketType value = PacketType::AUDIO; };
+template<> struct PacketTypeOf<ClockSync> { static constexpr PacketType value = PacketType::CLOCK_SYNC; };
+template<> struct PacketTypeOf<ControlBatch> { static constexpr PacketType value = PacketType::CONTROL_BATCH; };
+template<> struct PacketTypeOf<Heartbeat> { static constexpr PacketType value = PacketType::HEARTBEAT; };
+template<> struct PacketTypeOf<MappingDelta> { static constexpr PacketType value = PacketType::MAPPING_DELTA; };
+template<> struct PacketTypeOf<ControlStateChunk> { static constexpr PacketType value = PacketType::CONTROL_STATE; };
+
+/**
+ * @struct LegacySizeOf
+ * @brief Encapsulated data size sent by legacy (version 0) senders. Types which grew since only appended fields, the
+ * legacy size is the offset of the first one.
+ * @tparam T Encapsulated data type
+ */
+template<class T>
+struct LegacySizeOf { static constexpr size_t value = sizeof(T); };
+
+template<> struct LegacySizeOf<MappingData> { static constexpr size_t value = offsetof(MappingData, generation); };
+template<> struct LegacySizeOf<ControlResponse> { static constexpr size_t value = offsetof(ControlResponse, seq); };
+template<> struct LegacySizeOf<ControlQuery> { static constexpr size_t value = offsetof(ControlQuery, transaction_id); };
+template<> struct LegacySizeOf<ClockSync> { static constexpr size_t value = offsetof(ClockSync, flags); };
+
+/**
+ * @param version Protocol version of the sender
+ * @return Smallest valid OANPacket<T> size for that version
+ */
+template<class T>
+constexpr size_t packet_min_size(uint16_t version) {
+    return version == 0 ? sizeof(CommonHeader) + LegacySizeOf<T>::value : sizeof(OANPacket<T>);
+}
+
+/**
+ * Offset of the OANPacket in a received frame
+ */
+constexpr size_t OAN_PACKET_FRAME_OFFSET = sizeof(ethhdr) + sizeof(LowLatHeader);
+
+template<class T>
+class PacketView;
+
+/**
+ * @class FrameView
+ * @brief Validated view over a received frame (raw socket buffer, ring slot...). Checks once that the frame is long
+ * enough for the layer 2 and common headers, that the announced packet size fits in the frame and that the protocol
+ * version is supported. Nothing is copied : the view points into the receive buffer, which must outlive it and be
+ * aligned on alignof(std::max_align_t).
+ */
+class FrameView {
+public:
+    /**
+     * Constructor
+     * @param frame Received frame, starting with the ethernet header
+     * @param frame_size Received byte count
+     */
+    FrameView(uint8_t* frame, size_t frame_size) {
+        m_frame = frame;
+        m_frame_size = frame_size;
+        m_valid = false;
+
+        if (frame == nullptr || frame_size < OAN_PACKET_FRAME_OFFSET + sizeof(CommonHeader)) {
+            return;
+        }
+
+        // psize counts the whole OANPacket
+        if (llhdr().psize < sizeof(CommonHeader) || OAN_PACKET_FRAME_OFFSET + llhdr().psize > frame_size) {
+            return;
+        }
+
+        m_valid = header().version <= OAN_PROTOCOL_VERSION;
+    }
+
+    /**
+     * @return true if the frame holds a well formed OAN packet
+     */
+    bool valid() const {
+        return m_valid;
+    }
+
+    ethhdr& eth_header() const {
+        return *reinterpret_cast<ethhdr*>(m_frame);
+    }
+
+    LowLatHeader& llhdr() const {
+        return *reinterpret_cast<LowLatHeader*>(m_frame + sizeof(ethhdr));
+    }
+
+    CommonHeader& header() const {
+        return *reinterpret_cast<CommonHeader*>(m_frame + OAN_PACKET_FRAME_OFFSET);
+    }
+
+    /**
+     * Interpret the frame as a given packet type
+     * @tparam T Encapsulated data type
+     * @return Typed view, invalid if the type or size does not match
+     */
+    template<class T>
+    PacketView<T> as() const;
+
+protected:
+    uint8_t* m_frame;
+    size_t m_frame_size;
+    bool m_valid;
+};
+
+/**
+ * @class PacketView
+ * @brief FrameView which also checked the packet type and size for OANPacket<T>. Legacy packets shorter than the
+ * current struct are copied out and their missing fields zeroed, packet() then refers to the copy.
+ * @tparam T Encapsulated data type
+ */
+template<class T>
+class PacketView : public FrameView {
+    static_assert(OAN_PACKET_FRAME_OFFSET % alignof(OANPacket<T>) == 0, "Packet would be misaligned in the receive buffer");
+    static_assert(offsetof(LowLatPacket<OANPacket<T>>, payload) == OAN_PACKET_FRAME_OFFSET, "LowLatPacket must stay packed");
+
+public:
+    PacketView(uint8_t* frame, size_t frame_size) : FrameView(frame, frame_size) {
+        m_valid = m_valid
+                  && header().type == PacketTypeOf<T>::value
+                  && llhdr().psize >= packet_min_size<T>(header().version);
+
+        if (m_valid && llhdr().psize < sizeof(OANPacket<T>)) {
+            m_legacy = std::make_shared<OANPacket<T>>();
+            memset(m_legacy.get(), 0, sizeof(OANPacket<T>));
+            memcpy(m_legacy.get(), &header(), llhdr().psize);
+        }
+    }
+
+    /**
+     * @return The packet, in place in the receive buffer unless it was a short legacy one
+     */
+    OANPacket<T>& packet() const {
+        if (m_legacy) {
+            return *m_legacy;
+        }
+
+        return *reinterpret_cast<OANPacket<T>*>(m_frame + OAN_PACKET_FRAME_OFFSET);
+    }
+
+private:
+    std::shared_ptr<OANPacket<T>> m_legacy;     // Zero filled copy of a short legacy packet
+};
+
+template<class T>
+PacketView<T> FrameView::as() const {
+    return PacketView<T>(m_valid ? m_frame : nullptr, m_frame_size);
+}
+
+#endif //OPENAUDIONETWORK_PACKET_VIEW_H
@@ -8,6 +8,8 @@
 
 #if defined(__linux__) && !defined(BUILD_XDP_BACKEND)
 
+#include <linux/filter.h>
+
 std::optional<uint64_t> LowLatSocket::get_mac(uint16_t id) {
     return m_mapper->get_mac_by_uid(id);
 }
@@ -37,6 +39,16 @@ bool LowLatSocket::init_socket(std::string interface, EthProtocol proto) {
     m_iface_addr.sll_protocol = htons(proto);
     memcpy(m_iface_addr.sll_addr, meta.mac, 6);
 
+    // Only receive from the attached interface, hosts on several networks would otherwise see every one of them
+    sockaddr_ll bind_addr{};
+    bind_addr.sll_family = AF_PACKET;
+    bind_addr.sll_protocol = htons(proto);
+    bind_addr.sll_ifindex = meta.idx;
+    if (bind(m_socket, (sockaddr*)&bind_addr, sizeof(bind_addr)) < 0) {
+        std::cerr << "LLS Failed to bind low level socket to " << interface << ". Err = " << errno << std::endl;
+        return false;
+    }
+
     memset(m_hdr.h_dest, 0xFF, 6);
     memcpy(m_hdr.h_source, meta.mac, 6);
     m_hdr.h_proto = htons(proto);
@@ -108,4 +120,63 @@ bool LowLatSocket::write_packet_mac_addr(uint8_t *packet_buffer, uint16_t dest_u
     }
 }
 
+bool LowLatSocket::attach_modulo_filter(uint16_t byte_offset, uint8_t modulo, uint8_t remainder) {
+    if (modulo == 0) {
+        return false;
+    }
+
+    sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, byte_offset),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, modulo),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, remainder, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 0xFFFF),
+        BPF_STMT(BPF_RET | BPF_K, 0)
+    };
+
+    sock_fprog prog{};
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+
+    if (setsockopt(m_socket, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0) {
+        std::cerr << "LLS Failed to attach socket filter. Err = " << errno << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool LowLatSocket::set_receive_enabled(bool enabled) {
+    if (enabled) {
+        return setsockopt(m_socket, SOL_SOCKET, SO_DETACH_FILTER, nullptr, 0) == 0 || errno == ENOENT;
+    }
+
+    sock_filter code[] = {
+        BPF_STMT(BPF_RET | BPF_K, 0)
+    };
+
+    sock_fprog prog{};
+    prog.len = 1;
+    prog.filter = code;
+
+    if (setsockopt(m_socket, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0) {
+        std::cerr << "LLS Failed to attach socket filter. Err = " << errno << std::endl;
+        return false;
+    }
+
+    // Frames queued before the filter was attached would be read much later, drop them now
+    char frame[ETH_FRAME_LEN];
+    while (recv(m_socket, frame, sizeof(frame), MSG_DONTWAIT) > 0) {
+    }
+
+    return true;
+}
+
+bool LowLatSocket::set_receive_timeout(long timeout_us) {
+    timeval tv{};
+    tv.tv_sec = timeout_us / 1'000'000;
+    tv.tv_usec = timeout_us % 1'000'000;
+
+    return setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0;
+}
+
 #endif // __linux__
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include <net/if.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 #include "netutils/lls_common.h"
 
@@ -144,6 +145,30 @@ public:
         );
     }
 
+    /**
+     * Attach a kernel filter so that this socket only receives frames whose byte at the given offset
+     * satisfies (byte % modulo) == remainder. Used to split audio channels across several sockets.
+     * @param byte_offset Offset of the filtered byte from the start of the ethernet frame
+     * @param modulo Modulo applied to the filtered byte
+     * @param remainder Expected remainder
+     * @return true if the filter was attached
+     */
+    bool attach_modulo_filter(uint16_t byte_offset, uint8_t modulo, uint8_t remainder);
+
+    /**
+     * Stop or resume queueing received frames, the socket stays usable for sending
+     * @param enabled false to drop every incoming frame in the kernel
+     * @return true if the setting was applied
+     */
+    bool set_receive_enabled(bool enabled);
+
+    /**
+     * Set a timeout on blocking receive calls
+     * @param timeout_us Timeout in us, 0 to block forever
+     * @return true if the timeout was applied
+     */
+    bool set_receive_timeout(long timeout_us);
+
 private:
     /**
      * Finds a device MAC address based on its ID.
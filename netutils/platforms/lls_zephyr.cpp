@@ -79,4 +79,16 @@ bool LowLatSocket::write_packet_mac_addr(uint8_t *packet_buffer, uint16_t dest_u
     }
 }
 
+bool LowLatSocket::attach_modulo_filter(uint16_t, uint8_t, uint8_t) {
+    return false;
+}
+
+bool LowLatSocket::set_receive_enabled(bool) {
+    return false;
+}
+
+bool LowLatSocket::set_receive_timeout(long) {
+    return false;
+}
+
 #endif // __ZEPHYR__
\ No newline at end of file
@@ -127,6 +127,24 @@ public:
         return send_data_internal((uint8_t*)data, size);
     }
 
+    /**
+     * Attach a receive filter on the filtered byte. Not supported on this platform.
+     * @return Always false
+     */
+    bool attach_modulo_filter(uint16_t byte_offset, uint8_t modulo, uint8_t remainder);
+
+    /**
+     * Stop or resume queueing received frames. Not supported on this platform.
+     * @return Always false
+     */
+    bool set_receive_enabled(bool enabled);
+
+    /**
+     * Set a timeout on blocking receive calls. Not supported on this platform.
+     * @return Always false
+     */
+    bool set_receive_timeout(long timeout_us);
+
 private:
     /**
      * Finds a device MAC address based on its ID.
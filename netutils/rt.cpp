@@ -8,9 +8,15 @@
 
 
 #ifdef __linux__
+#include <alloca.h>
+#include <cerrno>
 #include <iostream>
+#include <malloc.h>
 #include <sched.h>
 #include <ctime>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #else
 #include <ctime>
 #endif
@@ -50,6 +56,82 @@ namespace oals::rt {
         clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, nullptr);
     }
 
+    bool lock_memory(size_t heap_prefault_bytes) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::cerr << "[oals::rt] lock_memory failed" << std::endl;
+            return false;
+        }
+
+        // Freed memory must stay in the heap, trimming or unmapping it would fault again on the next allocation
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+
+        if (heap_prefault_bytes > 0) {
+            auto* heap = static_cast<volatile uint8_t*>(malloc(heap_prefault_bytes));
+            if (heap != nullptr) {
+                for (size_t i = 0; i < heap_prefault_bytes; i += sysconf(_SC_PAGESIZE)) {
+                    heap[i] = 0;
+                }
+                free(const_cast<uint8_t*>(heap));
+            }
+        }
+
+        return true;
+    }
+
+    __attribute__((noinline)) void prefault_stack(size_t bytes) {
+        auto* stack = static_cast<volatile uint8_t*>(alloca(bytes));
+        for (size_t i = 0; i < bytes; i += sysconf(_SC_PAGESIZE)) {
+            stack[i] = 0;
+        }
+    }
+
+    // Layout of the kernel struct sched_attr, not exposed by older libc
+    struct DeadlineAttr {
+        uint32_t size;
+        uint32_t sched_policy;
+        uint64_t sched_flags;
+        int32_t sched_nice;
+        uint32_t sched_priority;
+        uint64_t sched_runtime;
+        uint64_t sched_deadline;
+        uint64_t sched_period;
+    };
+
+    bool set_thread_deadline(uint64_t runtime_ns, uint64_t deadline_ns, uint64_t period_ns) {
+#ifdef SYS_sched_setattr
+        DeadlineAttr attr{};
+        attr.size = sizeof(attr);
+        attr.sched_policy = 6;  // SCHED_DEADLINE
+        attr.sched_runtime = runtime_ns;
+        attr.sched_deadline = deadline_ns;
+        attr.sched_period = period_ns;
+
+        if (syscall(SYS_sched_setattr, 0, &attr, 0) == 0) {
+            return true;
+        }
+#endif // SYS_sched_setattr
+
+        std::cerr << "[oals::rt] set_thread_deadline failed" << std::endl;
+        return false;
+    }
+
+    uint64_t monotonic_ns() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+    }
+
+    void sleep_until(uint64_t deadline_ns) {
+        timespec ts{};
+        ts.tv_sec = deadline_ns / 1'000'000'000;
+        ts.tv_nsec = deadline_ns % 1'000'000'000;
+
+        // Signals interrupt the sleep, the absolute deadline makes resuming it exact
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+    }
+
 
 #else
     void set_thread_realtime(uint8_t) {
@@ -67,5 +149,29 @@ namespace oals::rt {
         ts.tv_nsec = ns % 1'000'000'000;
         nanosleep(&ts, nullptr);
     }
+
+    bool lock_memory(size_t) {
+        return false;
+    }
+
+    void prefault_stack(size_t) {
+    }
+
+    bool set_thread_deadline(uint64_t, uint64_t, uint64_t) {
+        return false;
+    }
+
+    uint64_t monotonic_ns() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+    }
+
+    void sleep_until(uint64_t deadline_ns) {
+        uint64_t now = monotonic_ns();
+        if (deadline_ns > now) {
+            precise_sleep(deadline_ns - now);
+        }
+    }
 #endif
 }
@@ -6,6 +6,7 @@
 
 #ifndef OPENAUDIONETWORK_RT_H
 #define OPENAUDIONETWORK_RT_H
+#include <cstddef>
 #include <cstdint>
 
 
@@ -14,6 +15,40 @@ namespace oals::rt {
     void set_running_cpu(int);
     void set_process_scheduler_rr(int);
     void precise_sleep(long);
+
+    /**
+     * Lock current and future pages in RAM and keep freed heap memory mapped, so that the RT path never page faults
+     * @param heap_prefault_bytes Heap grown, touched and released to the allocator ahead of time
+     * @return false if the memory could not be locked (missing CAP_IPC_LOCK or RLIMIT_MEMLOCK too low)
+     */
+    bool lock_memory(size_t heap_prefault_bytes);
+
+    /**
+     * Touch the calling thread stack so that its pages are resident before the RT loop starts
+     * @param bytes Stack depth to prefault
+     */
+    void prefault_stack(size_t bytes);
+
+    /**
+     * Put the calling thread under SCHED_DEADLINE
+     * @param runtime_ns CPU time guaranteed per period
+     * @param deadline_ns Time after each period start by which the runtime is granted
+     * @param period_ns Reservation period
+     * @return false if the kernel refused (no support, missing CAP_SYS_NICE, thread pinned to a CPU subset...)
+     */
+    bool set_thread_deadline(uint64_t runtime_ns, uint64_t deadline_ns, uint64_t period_ns);
+
+    /**
+     * @return CLOCK_MONOTONIC time in ns, the clock used by sleep_until
+     */
+    uint64_t monotonic_ns();
+
+    /**
+     * Sleep until an absolute CLOCK_MONOTONIC time. Unlike a relative sleep, time spent before the call does not
+     * shift the wakeup.
+     * @param deadline_ns Wakeup time
+     */
+    void sleep_until(uint64_t deadline_ns);
 }
 
 
@@ -0,0 +1,108 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#include "tstamp.h"
+
+#include <atomic>
+
+#ifdef __linux__
+#include <ctime>
+#endif // __linux__
+
+#if defined(__linux__) && defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TSTAMP_HAS_TSC
+#endif
+
+#ifndef __linux__
+extern uint64_t _now_us();
+#endif // __linux__
+
+namespace oals::tstamp {
+    static std::atomic<bool> s_tsc_enabled{false};
+
+#ifdef TSTAMP_HAS_TSC
+    // now = s_base_ns + ((tsc - s_base_tsc) * s_mult) >> 32
+    static uint64_t s_base_tsc;
+    static uint64_t s_base_ns;
+    static uint64_t s_mult;
+#endif // TSTAMP_HAS_TSC
+
+    static uint64_t clock_ns() {
+#ifdef __linux__
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return (uint64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+#else
+        return _now_us() * 1000;
+#endif // __linux__
+    }
+
+    bool enable_tsc() {
+#ifdef TSTAMP_HAS_TSC
+        if (s_tsc_enabled) {
+            return true;
+        }
+
+        // Invariant TSC : constant rate across P/C states
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1 << 8))) {
+            return false;
+        }
+
+        uint64_t start_ns = clock_ns();
+        uint64_t start_tsc = __rdtsc();
+
+        timespec wait{0, 20'000'000};
+        nanosleep(&wait, nullptr);
+
+        uint64_t end_ns = clock_ns();
+        uint64_t end_tsc = __rdtsc();
+
+        if (end_tsc <= start_tsc) {
+            return false;
+        }
+
+        s_mult = (uint64_t)(((unsigned __int128)(end_ns - start_ns) << 32) / (end_tsc - start_tsc));
+        s_base_tsc = end_tsc;
+        s_base_ns = end_ns;
+
+        s_tsc_enabled.store(true, std::memory_order_release);
+        return true;
+#else
+        return false;
+#endif // TSTAMP_HAS_TSC
+    }
+
+    bool tsc_enabled() {
+        return s_tsc_enabled.load(std::memory_order_relaxed);
+    }
+
+    uint64_t now_ns() {
+#ifdef TSTAMP_HAS_TSC
+        if (s_tsc_enabled.load(std::memory_order_acquire)) {
+            uint64_t delta = __rdtsc() - s_base_tsc;
+            return s_base_ns + (uint64_t)(((unsigned __int128)delta * s_mult) >> 32);
+        }
+#endif // TSTAMP_HAS_TSC
+
+        return clock_ns();
+    }
+
+    uint64_t epoch_offset_ns() {
+#ifdef __linux__
+        static const uint64_t offset = []() {
+            timespec ts{};
+            clock_gettime(CLOCK_REALTIME, &ts);
+            return (uint64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec - clock_ns();
+        }();
+
+        return offset;
+#else
+        return 0;
+#endif // __linux__
+    }
+}
@@ -0,0 +1,71 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef OPENAUDIONETWORK_TSTAMP_H
+#define OPENAUDIONETWORK_TSTAMP_H
+
+#include <cstdint>
+
+/**
+ * Monotonic timestamps for hot paths. Times come from CLOCK_MONOTONIC_RAW, which is never stepped nor slewed by NTP,
+ * or from the TSC once enable_tsc has calibrated it against that clock. The epoch of now_* is unspecified (boot on
+ * linux) : use them for local intervals only.
+ *
+ * now_epoch_* add a fixed offset to the same clock, read from CLOCK_REALTIME once per process. They stay monotonic but
+ * count from the Unix epoch, so that independently booted nodes start close to each other. Network time (clock sync,
+ * media timestamps) uses them.
+ */
+namespace oals::tstamp {
+    /**
+     * Calibrate and switch to the TSC fast path. Must be called before other threads read timestamps.
+     * @return true if the CPU has an invariant TSC and the fast path is now in use
+     */
+    bool enable_tsc();
+
+    /**
+     * @return true if the TSC fast path is in use
+     */
+    bool tsc_enabled();
+
+    /**
+     * @return Monotonic time in ns
+     */
+    uint64_t now_ns();
+
+    /**
+     * @return Monotonic time in us
+     */
+    inline uint64_t now_us() {
+        return now_ns() / 1000;
+    }
+
+    /**
+     * @return Monotonic time in ms
+     */
+    inline uint64_t now_ms() {
+        return now_ns() / 1000000;
+    }
+
+    /**
+     * @return Unix time minus monotonic time in ns, captured on first call
+     */
+    uint64_t epoch_offset_ns();
+
+    /**
+     * @return Monotonic time since the Unix epoch in us
+     */
+    inline uint64_t now_epoch_us() {
+        return (now_ns() + epoch_offset_ns()) / 1000;
+    }
+
+    /**
+     * @return Monotonic time since the Unix epoch in ms
+     */
+    inline uint64_t now_epoch_ms() {
+        return (now_ns() + epoch_offset_ns()) / 1000000;
+    }
+}
+
+#endif //OPENAUDIONETWORK_TSTAMP_H
@@ -0,0 +1,108 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Deterministic ClockServo harness: a drifting slave clock measured through sync exchanges with exponential
+// queueing jitter, checks the tracking error once locked and that the min-delay filter beats raw measurements.
+
+#include <cmath>
+#include <random>
+
+#include "common/ClockServo.h"
+#include "test_util.h"
+
+struct SimResult {
+    double max_error_us;        // Worst estimated offset error once settled
+    double raw_max_error_us;    // Worst raw measurement error over the same samples
+    double freq_error_ppm;      // Final frequency ratio error
+    size_t rejected;            // Samples dropped by the min-delay filter
+};
+
+static SimResult simulate(double jitter_mean_us, double drift_ppm, double initial_offset_us, uint64_t seed) {
+    constexpr double BASE_DELAY_US = 20.0;
+    constexpr double SYNC_INTERVAL_US = 125000.0;
+    constexpr int EXCHANGES = 800;
+    constexpr int SETTLE = 200;
+
+    std::mt19937_64 rng(seed);
+    std::exponential_distribution<double> queueing(jitter_mean_us > 0 ? 1.0 / jitter_mean_us : 1.0);
+    auto path_delay = [&]() {
+        return BASE_DELAY_US + (jitter_mean_us > 0 ? queueing(rng) : 0.0);
+    };
+
+    // local = master * (1 + drift) + initial offset
+    double drift = drift_ppm * 1e-6;
+    auto local_of = [&](double master) {
+        return master * (1.0 + drift) + initial_offset_us;
+    };
+
+    ClockServo servo;
+    SimResult result{0, 0, 0, 0};
+
+    for (int i = 0; i < EXCHANGES; i++) {
+        double t1 = 1e6 + i * SYNC_INTERVAL_US;             // Master sends SYNC
+        double t2 = local_of(t1 + path_delay());            // Slave receives it
+        double t3 = t2 + 50.0;                              // Slave sends DELAY_REQ (local)
+        double t3_master = (t3 - initial_offset_us) / (1.0 + drift);
+        double t4 = t3_master + path_delay();               // Master receives it
+
+        double offset = ((t2 - t1) - (t4 - t3)) / 2.0;
+        double delay = ((t2 - t1) + (t4 - t3)) / 2.0;
+
+        if (!servo.sample(std::llround(offset), std::llround(delay), (uint64_t)t3)) {
+            result.rejected++;
+        }
+
+        if (i >= SETTLE) {
+            double true_offset = t3 - t3_master;
+            result.max_error_us = std::max(result.max_error_us, std::fabs(servo.offset_at((uint64_t)t3) - true_offset));
+            result.raw_max_error_us = std::max(result.raw_max_error_us, std::fabs(offset - true_offset));
+        }
+    }
+
+    result.freq_error_ppm = std::fabs(servo.get_freq_ratio() - 1.0 / (1.0 + drift)) * 1e6;
+    return result;
+}
+
+static void check_jitter(double jitter_mean_us, double bound_us) {
+    SimResult r = simulate(jitter_mean_us, 50.0, 300.0, 42);
+    std::printf("servo: jitter mean %4.1f us -> max error %5.2f us (raw %6.2f us), freq error %.3f ppm, %zu rejected\n",
+                jitter_mean_us, r.max_error_us, r.raw_max_error_us, r.freq_error_ppm, r.rejected);
+
+    OAN_CHECK(r.max_error_us < bound_us);
+    OAN_CHECK(r.freq_error_ppm < 2.0);
+
+    if (jitter_mean_us > 0) {
+        OAN_CHECK(r.max_error_us < r.raw_max_error_us);
+    }
+
+    // Below the 20 us delay margin nothing is an outlier
+    if (jitter_mean_us >= 10.0) {
+        OAN_CHECK(r.rejected > 0);
+    }
+}
+
+static void check_step() {
+    // A master change moves the phase by 5 ms: the servo steps and locks again instead of slewing for minutes
+    ClockServo servo;
+    for (uint64_t i = 0; i < 10; i++) {
+        servo.sample(100, 20, 1'000'000 + i * 125'000);
+    }
+    OAN_CHECK(servo.get_state() == ClockServoState::LOCKED);
+
+    servo.sample(5100, 20, 2'250'000);
+    OAN_CHECK(servo.get_state() == ClockServoState::FREQ_ESTIMATE);
+    servo.sample(5100, 20, 2'375'000);
+    OAN_CHECK(servo.get_state() == ClockServoState::LOCKED);
+    OAN_CHECK(std::fabs(servo.offset_at(2'375'000) - 5100) < 1.0);
+}
+
+int main() {
+    check_jitter(0.0, 1.0);
+    check_jitter(2.0, 5.0);
+    check_jitter(10.0, 10.0);
+    check_jitter(30.0, 20.0);
+    check_step();
+    return 0;
+}
@@ -0,0 +1,189 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Control state synchronization between a node cache and a surface replica, chunks handed over directly. Checks a
+// full snapshot spanning several chunks, an incremental one, the full snapshot sent after a clear, and that a lost or
+// reordered chunk never lets the synced version advance.
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "common/ControlStateCache.h"
+#include "test_util.h"
+
+static constexpr uint16_t NODE_UID = 5;
+static constexpr uint16_t CONTROLS = 600;
+
+typedef std::map<uint32_t, ControlData> SurfaceState;
+
+static uint32_t key_of(const ControlData& data) {
+    return ((uint32_t)data.channel << 24) | ((uint32_t)data.elem_index << 16) | data.control_id;
+}
+
+static ControlData make_control(uint16_t i, uint32_t value) {
+    ControlData data{};
+    data.channel = i / 100;
+    data.elem_index = (i / 10) % 10;
+    data.control_id = i % 10;
+    data.control_type = (DataTypes)(i % 5);
+
+    // Within the range of each type, CUSTOM values fill every word
+    switch (data.control_type) {
+        case DataTypes::INT8:
+            data.data[0] = value & 0xFF;
+            break;
+        case DataTypes::INT16:
+            data.data[0] = value & 0xFFFF;
+            break;
+        case DataTypes::CUSTOM:
+            for (uint32_t& word : data.data) {
+                word = value++;
+            }
+            break;
+        default:
+            data.data[0] = value;
+            break;
+    }
+
+    return data;
+}
+
+static bool deliver(ControlStateReplica& replica, const std::vector<ControlStateChunkPacket>& chunks,
+                    const std::vector<size_t>& order, SurfaceState& state, int& fulls) {
+    bool synced = false;
+
+    for (size_t index : order) {
+        synced = replica.receive(NODE_UID, chunks[index].packet_data, [&state](const ControlData& data) {
+            state[key_of(data)] = data;
+        }, [&]() {
+            fulls++;
+            state.clear();
+        });
+    }
+
+    return synced;
+}
+
+static bool deliver(ControlStateReplica& replica, const std::vector<ControlStateChunkPacket>& chunks, SurfaceState& state, int& fulls) {
+    std::vector<size_t> order;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        order.push_back(i);
+    }
+
+    return deliver(replica, chunks, order, state, fulls);
+}
+
+static void check_same(const ControlStateCache& cache, const SurfaceState& state) {
+    OAN_CHECK(state.size() == cache.size());
+
+    for (auto& [key, data] : state) {
+        auto stored = cache.get(data.channel, data.elem_index, data.control_id);
+        OAN_CHECK(stored.has_value());
+        OAN_CHECK(stored->control_type == data.control_type);
+        OAN_CHECK(memcmp(stored->data, data.data, sizeof(data.data)) == 0);
+    }
+}
+
+int main() {
+    ControlStateCache cache;
+    ControlStateReplica replica;
+    SurfaceState state;
+    int fulls = 0;
+
+    for (uint16_t i = 0; i < CONTROLS; i++) {
+        OAN_CHECK(cache.apply(make_control(i, 1000 + i)));
+    }
+    OAN_CHECK(!cache.apply(make_control(0, 1000)));
+    OAN_CHECK(cache.version() == CONTROLS);
+
+    // Full snapshot over several chunks, each decoding on its own
+    auto chunks = cache.encode(replica.synced_version(NODE_UID));
+    OAN_CHECK(chunks.size() >= 3);
+    size_t decoded = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const ControlStateChunk& chunk = chunks[i].packet_data;
+        OAN_CHECK(chunk.seq == i && chunk.full == 1 && chunk.since == 0 && chunk.version == CONTROLS);
+        OAN_CHECK(chunk.last == (i + 1 == chunks.size()));
+        OAN_CHECK(ControlStateCache::decode(chunk, [](const ControlData&) {}) == chunk.count);
+        decoded += chunk.count;
+    }
+    OAN_CHECK(decoded == CONTROLS);
+
+    OAN_CHECK(deliver(replica, chunks, state, fulls));
+    OAN_CHECK(fulls == 1);
+    OAN_CHECK(replica.synced_version(NODE_UID) == CONTROLS);
+    check_same(cache, state);
+
+    // Incremental: only the changed controls, applied over the held state
+    for (uint16_t i : {3, 250, 599}) {
+        OAN_CHECK(cache.apply(make_control(i, 7000 + i)));
+    }
+    chunks = cache.encode(replica.synced_version(NODE_UID));
+    OAN_CHECK(chunks.size() == 1);
+    OAN_CHECK(chunks[0].packet_data.full == 0 && chunks[0].packet_data.since == CONTROLS && chunks[0].packet_data.count == 3);
+    OAN_CHECK(deliver(replica, chunks, state, fulls));
+    OAN_CHECK(fulls == 1);
+    OAN_CHECK(replica.synced_version(NODE_UID) == cache.version());
+    check_same(cache, state);
+
+    // Nothing changed: an empty snapshot still confirms the version
+    chunks = cache.encode(replica.synced_version(NODE_UID));
+    OAN_CHECK(chunks.size() == 1 && chunks[0].packet_data.count == 0 && chunks[0].packet_data.last == 1);
+    OAN_CHECK(deliver(replica, chunks, state, fulls));
+
+    // Lost and reordered chunks: values may be applied, the version must not advance
+    uint32_t synced = replica.synced_version(NODE_UID);
+    for (uint16_t i = 0; i < CONTROLS; i++) {
+        cache.apply(make_control(i, 20000 + i));
+    }
+    chunks = cache.encode(synced);
+    OAN_CHECK(chunks.size() >= 3 && chunks[0].packet_data.full == 0);
+
+    std::vector<size_t> lost_middle, lost_first, reordered;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (i != 1) {
+            lost_middle.push_back(i);
+        }
+        if (i != 0) {
+            lost_first.push_back(i);
+        }
+        reordered.push_back(i);
+    }
+    std::swap(reordered[1], reordered[2]);
+
+    for (auto& order : {lost_middle, lost_first, reordered}) {
+        OAN_CHECK(!deliver(replica, chunks, order, state, fulls));
+        OAN_CHECK(replica.synced_version(NODE_UID) == synced);
+    }
+
+    // A snapshot based on another version than the synced one does not complete either
+    OAN_CHECK(!deliver(replica, cache.encode(synced - 1), state, fulls));
+    OAN_CHECK(replica.synced_version(NODE_UID) == synced);
+
+    OAN_CHECK(deliver(replica, cache.encode(replica.synced_version(NODE_UID)), state, fulls));
+    OAN_CHECK(replica.synced_version(NODE_UID) == cache.version());
+    check_same(cache, state);
+    OAN_CHECK(fulls == 1);
+
+    // Removed controls: after a clear, a surface synced before it gets a flagged full snapshot
+    cache.clear();
+    OAN_CHECK(cache.size() == 0);
+    cache.apply(make_control(42, 1));
+    cache.apply(make_control(43, 2));
+    chunks = cache.encode(replica.synced_version(NODE_UID));
+    OAN_CHECK(chunks.size() == 1 && chunks[0].packet_data.full == 1 && chunks[0].packet_data.count == 2);
+    OAN_CHECK(deliver(replica, chunks, state, fulls));
+    OAN_CHECK(fulls == 2);
+    OAN_CHECK(replica.synced_version(NODE_UID) == cache.version());
+    check_same(cache, state);
+
+    // Forgotten nodes start over with a full snapshot
+    replica.forget(NODE_UID);
+    OAN_CHECK(replica.synced_version(NODE_UID) == 0);
+    OAN_CHECK(cache.encode(0)[0].packet_data.full == 1);
+
+    return 0;
+}
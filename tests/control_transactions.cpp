@@ -0,0 +1,231 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Control request/response matching, requests sent on the loopback interface to a node that never answers: answers
+// are fed by hand. Checks transaction ID matching, stale generations, timeouts and retry counts, legacy (version 0)
+// oldest first matching and the (node, pid, seq) deduplication of creations. Needs root for the raw sockets and is
+// skipped otherwise.
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "common/ControlTransactions.h"
+#include "common/NetworkMapper.h"
+#include "test_util.h"
+
+static constexpr uint16_t SELF_UID = 1;
+static constexpr uint16_t NODE_UID = 5;
+static constexpr uint16_t OTHER_UID = 6;
+static constexpr uint64_t TIMEOUT_US = 1000;
+
+static ControlQueryPacket query_answer(ControlTransactionId id, uint8_t version = OAN_PROTOCOL_VERSION) {
+    ControlQueryPacket pck{};
+    pck.header.type = PacketType::CONTROL_QUERY;
+    pck.header.version = version;
+    pck.packet_data.qtype = ControlQueryType::PIPES_MAP;
+    pck.packet_data.transaction_id = id;
+    return pck;
+}
+
+static ControlResponsePacket create_answer(uint16_t pid, uint8_t seq, uint8_t version = OAN_PROTOCOL_VERSION) {
+    ControlResponsePacket pck{};
+    pck.header.type = PacketType::CONTROL_RESPONSE;
+    pck.header.version = version;
+    pck.packet_data.pid = pid;
+    pck.packet_data.seq = seq;
+    return pck;
+}
+
+static LowLatHeader from(uint16_t sender_uid) {
+    LowLatHeader llhdr{};
+    llhdr.sender_uid = sender_uid;
+    llhdr.dest_uid = SELF_UID;
+    return llhdr;
+}
+
+static void wait_all_done(ControlTransactions& transactions) {
+    for (int i = 0; i < 1000 && transactions.pending() > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::microseconds(TIMEOUT_US / 2));
+        transactions.update();
+    }
+}
+
+static void check_transaction_ids(ControlTransactions& transactions) {
+    ControlQuery query{};
+    query.qtype = ControlQueryType::PIPES_MAP;
+    std::vector<ControlTransactionId> order;
+
+    ControlTransactionId first = transactions.query(NODE_UID, query, [&](const ControlQueryResult& result) {
+        OAN_CHECK(result.status == ControlStatus::OK && result.node_uid == NODE_UID);
+        order.push_back(result.response.transaction_id);
+    });
+    ControlTransactionId second = transactions.query(NODE_UID, query, [&](const ControlQueryResult& result) {
+        OAN_CHECK(result.status == ControlStatus::OK);
+        order.push_back(result.response.transaction_id);
+    });
+    OAN_CHECK(first != 0 && second != 0 && first != second);
+
+    // Answers lead to their own transaction, whatever their order, and only from the queried node
+    OAN_CHECK(!transactions.process_query_response(query_answer(second), from(OTHER_UID)));
+    OAN_CHECK(transactions.process_query_response(query_answer(second), from(NODE_UID)));
+    OAN_CHECK(!transactions.process_query_response(query_answer(second), from(NODE_UID)));
+    OAN_CHECK(transactions.process_query_response(query_answer(first), from(NODE_UID)));
+    OAN_CHECK(order.size() == 2 && order[0] == second && order[1] == first);
+
+    // The slot is reused with a new generation, a late answer to the completed query is dropped
+    bool completed = false;
+    ControlTransactionId reused = transactions.query(NODE_UID, query, [&](const ControlQueryResult&) {
+        completed = true;
+    });
+    OAN_CHECK((reused & (CONTROL_TRANSACTION_CAPACITY - 1)) == (first & (CONTROL_TRANSACTION_CAPACITY - 1)));
+    OAN_CHECK(reused != first);
+    OAN_CHECK(!transactions.process_query_response(query_answer(first), from(NODE_UID)));
+    OAN_CHECK(!completed);
+    OAN_CHECK(transactions.process_query_response(query_answer(reused), from(NODE_UID)));
+    OAN_CHECK(completed);
+
+    // Cancelled requests complete once, answers to them are dropped too
+    ControlStatus status = ControlStatus::OK;
+    ControlTransactionId cancelled = transactions.query(NODE_UID, query, [&](const ControlQueryResult& result) {
+        status = result.status;
+    });
+    OAN_CHECK(transactions.cancel(cancelled));
+    OAN_CHECK(status == ControlStatus::CANCELLED);
+    OAN_CHECK(!transactions.cancel(cancelled));
+    OAN_CHECK(!transactions.process_query_response(query_answer(cancelled), from(NODE_UID)));
+    OAN_CHECK(transactions.pending() == 0);
+}
+
+static void check_timeouts(ControlTransactions& transactions) {
+    ControlQuery query{};
+    query.qtype = ControlQueryType::PIPES_MAP;
+    ControlQueryResult default_retries{}, two_retries{}, no_retry{};
+
+    transactions.query(NODE_UID, query, [&](const ControlQueryResult& result) { default_retries = result; });
+    transactions.query(NODE_UID, query, [&](const ControlQueryResult& result) { two_retries = result; }, 0, 2);
+    transactions.query(NODE_UID, query, [&](const ControlQueryResult& result) { no_retry = result; }, 0, 0);
+
+    // Creations are only retransmitted when asked for
+    ControlPipeCreate create{};
+    create.pid = 7;
+    ControlCreateResult create_default{}, create_retried{};
+
+    create.seq = 1;
+    transactions.create(NODE_UID, create, [&](const ControlCreateResult& result) { create_default = result; });
+    create.seq = 2;
+    transactions.create(NODE_UID, create, [&](const ControlCreateResult& result) { create_retried = result; }, 0, 2);
+
+    wait_all_done(transactions);
+    OAN_CHECK(transactions.pending() == 0);
+
+    OAN_CHECK(default_retries.status == ControlStatus::TIMEOUT && default_retries.attempts == 4);
+    OAN_CHECK(two_retries.status == ControlStatus::TIMEOUT && two_retries.attempts == 3);
+    OAN_CHECK(no_retry.status == ControlStatus::TIMEOUT && no_retry.attempts == 1);
+    OAN_CHECK(create_default.status == ControlStatus::TIMEOUT && create_default.attempts == 1);
+    OAN_CHECK(create_retried.status == ControlStatus::TIMEOUT && create_retried.attempts == 3);
+}
+
+static void check_legacy(ControlTransactions& transactions) {
+    ControlQuery query{};
+    query.qtype = ControlQueryType::PIPES_MAP;
+    std::vector<int> order;
+
+    // Legacy nodes answer in order without the transaction ID: the oldest pending query of that type completes
+    for (int i = 0; i < 3; i++) {
+        transactions.query(NODE_UID, query, [&order, i](const ControlQueryResult& result) {
+            OAN_CHECK(result.status == ControlStatus::OK);
+            order.push_back(i);
+        });
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+
+    ControlQueryPacket other_type = query_answer(0, 0);
+    other_type.packet_data.qtype = ControlQueryType::PHY_OUT_MAP;
+    OAN_CHECK(!transactions.process_query_response(other_type, from(NODE_UID)));
+    OAN_CHECK(!transactions.process_query_response(query_answer(0, 0), from(OTHER_UID)));
+
+    for (int i = 0; i < 3; i++) {
+        OAN_CHECK(transactions.process_query_response(query_answer(0, 0), from(NODE_UID)));
+    }
+    OAN_CHECK(!transactions.process_query_response(query_answer(0, 0), from(NODE_UID)));
+    OAN_CHECK(order == (std::vector<int>{0, 1, 2}));
+
+    // Same for creations, on the pipe ID since legacy answers carry no seq
+    ControlPipeCreate create{};
+    create.pid = 9;
+    order.clear();
+
+    for (int i = 0; i < 2; i++) {
+        create.seq = 10 + i;
+        OAN_CHECK(transactions.create(NODE_UID, create, [&order, i](const ControlCreateResult& result) {
+            OAN_CHECK(result.status == ControlStatus::OK);
+            order.push_back(i);
+        }) != 0);
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+
+    OAN_CHECK(!transactions.process_response(create_answer(8, 0, 0), from(NODE_UID)));
+    OAN_CHECK(transactions.process_response(create_answer(9, 0, 0), from(NODE_UID)));
+    OAN_CHECK(transactions.process_response(create_answer(9, 0, 0), from(NODE_UID)));
+    OAN_CHECK(order == (std::vector<int>{0, 1}));
+    OAN_CHECK(transactions.pending() == 0);
+}
+
+static void check_create_dedup(ControlTransactions& transactions) {
+    ControlPipeCreate create{};
+    create.pid = 3;
+    create.seq = 1;
+    std::vector<uint16_t> completed;
+    auto on_complete = [&](const ControlCreateResult& result) {
+        OAN_CHECK(result.status == ControlStatus::OK);
+        completed.push_back(result.node_uid);
+    };
+
+    // Two pending creations of the same element could not be told apart
+    ControlTransactionId first = transactions.create(NODE_UID, create, on_complete);
+    OAN_CHECK(first != 0);
+    OAN_CHECK(transactions.create(NODE_UID, create, on_complete) == 0);
+    OAN_CHECK(transactions.create(OTHER_UID, create, on_complete) != 0);
+    create.seq = 2;
+    OAN_CHECK(transactions.create(NODE_UID, create, on_complete) != 0);
+    OAN_CHECK(transactions.pending() == 3);
+
+    // Answers match on (node, pid, seq)
+    OAN_CHECK(!transactions.process_response(create_answer(3, 3), from(NODE_UID)));
+    OAN_CHECK(transactions.process_response(create_answer(3, 2), from(NODE_UID)));
+    OAN_CHECK(transactions.process_response(create_answer(3, 1), from(OTHER_UID)));
+    OAN_CHECK(transactions.process_response(create_answer(3, 1), from(NODE_UID)));
+    OAN_CHECK(!transactions.process_response(create_answer(3, 1), from(NODE_UID)));
+    OAN_CHECK(completed == (std::vector<uint16_t>{NODE_UID, OTHER_UID, NODE_UID}));
+
+    // Completed, the element may be created again
+    create.seq = 1;
+    OAN_CHECK(transactions.create(NODE_UID, create, on_complete) != 0);
+    OAN_CHECK(transactions.process_response(create_answer(3, 1), from(NODE_UID)));
+    OAN_CHECK(transactions.pending() == 0);
+}
+
+int main() {
+    PeerConf conf{};
+    snprintf(conf.dev_name, sizeof(conf.dev_name), "control");
+    conf.iface = "lo";
+    conf.uid = SELF_UID;
+    conf.dev_type = DeviceType::CONTROL_SURFACE;
+
+    auto mapper = std::make_shared<NetworkMapper>(conf);
+    auto router = std::make_shared<AudioRouter>(SELF_UID);
+    if (!router->init_router("lo", mapper)) {
+        return OAN_TEST_SKIP;
+    }
+
+    ControlTransactions transactions{router, TIMEOUT_US, 3};
+    check_transaction_ids(transactions);
+    check_timeouts(transactions);
+    check_legacy(transactions);
+    check_create_dedup(transactions);
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Large network simulation: simulated peers announce themselves with the mapper jitter and send heartbeats at the
+// budgeted interval to one real NetworkMapper, fed through process_frame in real time. Checks that every peer is
+// discovered and never reported lost, and that the heartbeat rate stays within MAPPER_HEARTBEAT_BUDGET.
+
+#include <chrono>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <thread>
+
+#include "common/NetworkMapper.h"
+#include "test_util.h"
+
+static constexpr uint16_t HEARTBEAT_MS = 50;
+static constexpr uint64_t ANNOUNCE_MS = 1000;     // Shortened from the 5 s default to keep the run short
+static constexpr uint64_t RUN_MS = 4000;
+static constexpr uint16_t OBSERVER_UID = 1;
+
+enum SimEventKind {
+    SIM_ANNOUNCE,
+    SIM_HEARTBEAT
+};
+
+struct SimEvent {
+    uint64_t due_us;
+    uint16_t uid;
+    SimEventKind kind;
+
+    bool operator>(const SimEvent& other) const {
+        return due_us > other.due_us;
+    }
+};
+
+template<class T>
+static size_t build_frame(uint8_t* frame, uint16_t sender_uid, PacketType type, const T& data) {
+    OANPacket<T> pck{};
+    pck.header.type = type;
+    pck.header.version = OAN_PROTOCOL_VERSION;
+    pck.packet_data = data;
+
+    memset(frame, 0, OAN_PACKET_FRAME_OFFSET);
+    LowLatHeader llhdr{sender_uid, 0, sizeof(pck)};
+    memcpy(frame + sizeof(ethhdr), &llhdr, sizeof(llhdr));
+    memcpy(frame + OAN_PACKET_FRAME_OFFSET, &pck, sizeof(pck));
+
+    return OAN_PACKET_FRAME_OFFSET + sizeof(pck);
+}
+
+static MappingData peer_data(uint16_t uid) {
+    MappingData data{};
+    snprintf(data.dev_name, sizeof(data.dev_name), "sim-%u", uid);
+    data.self_address = 0x020000000000ULL | uid;
+    data.self_uid = uid;
+    data.type = DeviceType::AUDIO_IO_INTERFACE;
+    data.ck_type = CKTYPE_NONE;
+
+    return data;
+}
+
+static void simulate(uint16_t nodes) {
+    PeerConf conf{};
+    snprintf(conf.dev_name, sizeof(conf.dev_name), "observer");
+    conf.iface = "lo";
+    conf.uid = OBSERVER_UID;
+    conf.dev_type = DeviceType::CONTROL_SURFACE;
+
+    NetworkMapper mapper{conf};
+    mapper.configure_liveness(HEARTBEAT_MS, ANNOUNCE_MS);
+
+    // Every simulated peer sees the same network size as the observer
+    uint16_t interval_ms = NetworkMapper::heartbeat_interval_for(HEARTBEAT_MS, nodes);
+
+    std::mt19937_64 rng(nodes);
+    std::uniform_int_distribution<uint64_t> announce_jitter(ANNOUNCE_MS * 4 / 5 * 1000, ANNOUNCE_MS * 6 / 5 * 1000);
+    std::uniform_int_distribution<uint64_t> phase(0, (uint64_t)interval_ms * 1000);
+
+    auto clock_start = std::chrono::steady_clock::now();
+    auto elapsed_us = [&]() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clock_start).count();
+    };
+
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<>> events;
+    for (uint16_t i = 0; i < nodes; i++) {
+        uint16_t uid = OBSERVER_UID + 1 + i;
+        events.push({announce_jitter(rng), uid, SIM_ANNOUNCE});
+        events.push({phase(rng), uid, SIM_HEARTBEAT});
+    }
+
+    alignas(std::max_align_t) uint8_t frame[sizeof(LowLatPacket<MappingPacket>)];
+    uint64_t next_tick = (uint64_t)HEARTBEAT_MS * 1000;
+    uint64_t heartbeats = 0;
+    uint64_t frames = 0;
+    uint64_t process_ns = 0;
+    size_t joined = 0;
+    size_t lost = 0;
+    uint64_t converged_us = 0;
+
+    while (true) {
+        uint64_t now = elapsed_us();
+        if (now >= RUN_MS * 1000) {
+            break;
+        }
+
+        // Observer liveness tick, as scheduled by schedule_on
+        if (now >= next_tick) {
+            mapper.mapper_update();
+            next_tick += (uint64_t)HEARTBEAT_MS * 1000;
+
+            PeerEvent event;
+            while (mapper.poll_peer_event(event)) {
+                joined += event.type == PEER_JOINED;
+                lost += event.type == PEER_LOST;
+            }
+
+            if (converged_us == 0 && joined == nodes) {
+                converged_us = now;
+            }
+        }
+
+        if (events.empty() || events.top().due_us > now) {
+            uint64_t until = std::min(next_tick, events.empty() ? next_tick : events.top().due_us);
+            std::this_thread::sleep_for(std::chrono::microseconds(until > now ? until - now : 0));
+            continue;
+        }
+
+        SimEvent event = events.top();
+        events.pop();
+
+        size_t size;
+        if (event.kind == SIM_ANNOUNCE) {
+            size = build_frame(frame, event.uid, PacketType::MAPPING, peer_data(event.uid));
+            events.push({event.due_us + announce_jitter(rng), event.uid, SIM_ANNOUNCE});
+        } else {
+            Heartbeat hb{};
+            hb.self_uid = event.uid;
+            hb.interval_ms = interval_ms;
+            size = build_frame(frame, event.uid, PacketType::HEARTBEAT, hb);
+            events.push({event.due_us + (uint64_t)interval_ms * 1000, event.uid, SIM_HEARTBEAT});
+            heartbeats++;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        mapper.process_frame(frame, size);
+        process_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        frames++;
+    }
+
+    double heartbeat_rate = (double)heartbeats * 1000.0 / RUN_MS;
+    std::printf("mapper_sim: %u nodes, heartbeat %u ms, %.0f heartbeats/s, converged in %.2f s, %lu frames at %.0f ns, %zu lost\n",
+                nodes, interval_ms, heartbeat_rate, converged_us / 1e6, frames, (double)process_ns / frames, lost);
+
+    OAN_CHECK(converged_us != 0);
+    OAN_CHECK(lost == 0);
+    OAN_CHECK(heartbeat_rate <= MAPPER_HEARTBEAT_BUDGET * 1.05);
+    OAN_CHECK(mapper.get_peer_store_stats().rejected == 0);
+
+    for (uint16_t i = 0; i < nodes; i++) {
+        OAN_CHECK(mapper.get_mac_by_uid(OBSERVER_UID + 1 + i).has_value());
+    }
+}
+
+int main() {
+    simulate(500);
+    simulate(1000);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// MixBus ordering rules, and summing cost of 64 sources into 32 buses per period.
+
+#include <map>
+#include <vector>
+
+#include "common/MixBus.h"
+#include "netutils/tstamp.h"
+#include "test_util.h"
+
+static AudioPacket make_packet(uint8_t channel, uint8_t source, uint64_t timestamp, float value) {
+    AudioPacket pck{};
+    pck.header.type = PacketType::AUDIO;
+    pck.header.timestamp = timestamp;
+    pck.packet_data.channel = channel;
+    pck.packet_data.source_channel = source;
+    for (float& sample : pck.packet_data.samples) {
+        sample = value;
+    }
+
+    return pck;
+}
+
+static void test_ordering() {
+    MixBus bus;
+    bus.add_source(1, 10);
+    bus.add_source(1, 11);
+
+    std::map<uint64_t, int> emitted;
+    std::vector<uint16_t> sources;
+    bus.set_block_callback([&](MixBusBlock& block) {
+        emitted[block.timestamp]++;
+        sources.push_back(block.source_count);
+    });
+
+    // Timestamp 0 is a valid period
+    bus.accumulate(make_packet(1, 10, 0, 1.0f));
+    bus.accumulate(make_packet(1, 11, 0, 1.0f));
+    OAN_CHECK(emitted[0] == 1 && sources.back() == 2);
+
+    // Period 1000 partial, 2000 starts: 1000 emitted partial
+    bus.accumulate(make_packet(1, 10, 1000, 1.0f));
+    bus.accumulate(make_packet(1, 10, 2000, 1.0f));
+    OAN_CHECK(emitted[1000] == 1 && sources.back() == 1);
+
+    // Late contribution to the emitted period: dropped, must not emit 2000 early nor start a second 1000 block
+    bus.accumulate(make_packet(1, 11, 1000, 1.0f));
+    OAN_CHECK(emitted[1000] == 1 && emitted.count(2000) == 0);
+
+    // Older than the pending block (after an out of order arrival): dropped
+    bus.accumulate(make_packet(1, 11, 0, 1.0f));
+    OAN_CHECK(emitted[0] == 1 && emitted.count(2000) == 0);
+
+    bus.accumulate(make_packet(1, 11, 2000, 1.0f));
+    OAN_CHECK(emitted[2000] == 1 && sources.back() == 2);
+
+    bus.flush();
+    for (auto& [timestamp, count] : emitted) {
+        OAN_CHECK(count == 1);
+    }
+}
+
+static void bench_64_sources_32_buses() {
+    constexpr int SOURCES = 64;
+    constexpr int BUSES = 32;
+    constexpr int PERIODS = 2000;
+
+    MixBus bus;
+    for (int b = 0; b < BUSES; b++) {
+        for (int s = 0; s < SOURCES; s++) {
+            bus.add_source(b, s);
+        }
+    }
+
+    uint64_t blocks = 0;
+    float checksum = 0;
+    bus.set_block_callback([&](MixBusBlock& block) {
+        blocks++;
+        checksum += block.samples[0];
+        OAN_CHECK(block.source_count == SOURCES);
+    });
+
+    std::vector<AudioPacket> period;
+    for (int b = 0; b < BUSES; b++) {
+        for (int s = 0; s < SOURCES; s++) {
+            period.push_back(make_packet(b, s, 0, 0.25f));
+        }
+    }
+
+    uint64_t start = oals::tstamp::now_ns();
+    for (int p = 1; p <= PERIODS; p++) {
+        for (auto& pck : period) {
+            pck.header.timestamp = p * 1333;
+            bus.accumulate(pck);
+        }
+    }
+    uint64_t elapsed = oals::tstamp::now_ns() - start;
+
+    OAN_CHECK(blocks == (uint64_t)PERIODS * BUSES);
+    OAN_CHECK(checksum == PERIODS * BUSES * SOURCES * 0.25f);
+
+    double per_period_us = elapsed / 1000.0 / PERIODS;
+    std::printf("mixbus: %d sources x %d buses, %.1f us per period (%.1f ns per contribution), %.1f%% of a 48 kHz / 64 frames period\n",
+                SOURCES, BUSES, per_period_us, (double)elapsed / PERIODS / (SOURCES * BUSES), per_period_us / 1333.3 * 100);
+}
+
+int main() {
+    test_ordering();
+    bench_64_sources_32_buses();
+    return 0;
+}
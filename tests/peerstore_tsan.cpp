@@ -0,0 +1,101 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Stress of the lock-free PeerStore lookups, built with ThreadSanitizer: one writer churns the store (inserts,
+// removals, temporary peer evictions) while readers resolve MACs. A reader must never see the MAC of another UID.
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "common/PeerStore.h"
+#include "test_util.h"
+
+static constexpr uint16_t UID_RANGE = 400;     // Above the temporary capacity, slots get recycled for other UIDs
+static constexpr int READERS = 3;
+
+static uint64_t mac_of(uint16_t uid) {
+    return 0x020000000000ULL | ((uint64_t)uid << 8) | (uid & 0xFF);
+}
+
+int main() {
+    PeerStore store;
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> lookups{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> mismatches{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&, r]() {
+            std::mt19937 rng(r + 1);
+            std::uniform_int_distribution<uint16_t> pick(1, UID_RANGE);
+            uint64_t local_lookups = 0;
+            uint64_t local_hits = 0;
+
+            while (running.load(std::memory_order_relaxed)) {
+                uint16_t uid = pick(rng);
+                auto mac = store.find_mac(uid);
+                store.mark_used(uid, local_lookups);
+
+                if (mac.has_value()) {
+                    local_hits++;
+                    if (mac.value() != mac_of(uid)) {
+                        mismatches.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                local_lookups++;
+            }
+
+            lookups.fetch_add(local_lookups);
+            hits.fetch_add(local_hits);
+        });
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint16_t> pick(1, UID_RANGE);
+    std::uniform_int_distribution<int> action(0, 3);
+    uint64_t writes = 0;
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (std::chrono::steady_clock::now() < end) {
+        uint16_t uid = pick(rng);
+
+        MappingData data{};
+        data.self_uid = uid;
+        data.self_address = mac_of(uid);
+
+        switch (action(rng)) {
+            case 0:
+                store.remove(uid);
+                break;
+            case 1:
+                store.upsert(data, writes, PEER_SLOT_KNOWN);
+                break;
+            default:
+                store.upsert(data, writes, PEER_SLOT_TEMP);
+                break;
+        }
+
+        if (writes % 64 == 0) {
+            store.expire_temp(writes, 256);
+        }
+        writes++;
+    }
+
+    running = false;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    std::printf("peerstore_tsan: %lu writes, %lu lookups, %lu hits\n", writes, lookups.load(), hits.load());
+
+    OAN_CHECK(mismatches.load() == 0);
+    OAN_CHECK(hits.load() > 0);
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Dual link audio redundancy. The stream table is checked directly (deduplication, unstamped frames, full table,
+// idle streams ageing out), then frames are sent over two veth pairs with losses on each link: every frame must be
+// delivered exactly once, and traffic addressed to other nodes must neither be delivered nor take stream entries.
+// The veth part needs root and is skipped otherwise.
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <unistd.h>
+
+#include "common/AudioRedundancy.h"
+#include "common/packet_view.h"
+#include "test_util.h"
+
+static constexpr uint16_t SELF_UID = 2;
+static constexpr uint16_t OTHER_UID = 3;
+static constexpr uint16_t SENDER_UID = 10;
+static constexpr uint8_t CHANNEL = 3;
+static constexpr size_t FRAMES = 400;
+static constexpr uint64_t PERIOD_US = 1333;
+
+static const char* LINKS[2][2] = {{"oanred0a", "oanred0b"}, {"oanred1a", "oanred1b"}};
+
+static void check_stream_table() {
+    AudioRedundancy redundancy{SELF_UID};
+
+    // One copy per timestamp, whichever link comes first
+    OAN_CHECK(redundancy.accept(SENDER_UID, CHANNEL, 1000, AUDIO_LINK_SECONDARY));
+    OAN_CHECK(!redundancy.accept(SENDER_UID, CHANNEL, 1000, AUDIO_LINK_PRIMARY));
+    OAN_CHECK(redundancy.accept(SENDER_UID, CHANNEL, 1000 + PERIOD_US, AUDIO_LINK_PRIMARY));
+    OAN_CHECK(redundancy.stats().duplicates == 1);
+
+    // Unstamped frames only from the primary link
+    OAN_CHECK(redundancy.accept(SENDER_UID, CHANNEL, 0, AUDIO_LINK_PRIMARY));
+    OAN_CHECK(!redundancy.accept(SENDER_UID, CHANNEL, 0, AUDIO_LINK_SECONDARY));
+    OAN_CHECK(redundancy.stats().unstamped == 1);
+
+    // Fill the table, the next stream is delivered untracked: both copies go through
+    redundancy.reset();
+    for (uint32_t i = 0; i < AUDIO_REDUNDANCY_MAX_STREAMS; i++) {
+        OAN_CHECK(redundancy.accept(100 + i / 8, i % 8, 1000, AUDIO_LINK_PRIMARY));
+    }
+    OAN_CHECK(redundancy.accept(SENDER_UID, CHANNEL, 1000, AUDIO_LINK_PRIMARY));
+    OAN_CHECK(redundancy.accept(SENDER_UID, CHANNEL, 1000, AUDIO_LINK_SECONDARY));
+    OAN_CHECK(redundancy.stats().untracked == 2);
+
+    // Every stream went idle, the new one takes an entry and is deduplicated again
+    uint64_t later = 1000 + AUDIO_REDUNDANCY_IDLE_US + 1;
+    OAN_CHECK(redundancy.accept(SENDER_UID, CHANNEL, later, AUDIO_LINK_PRIMARY));
+    OAN_CHECK(!redundancy.accept(SENDER_UID, CHANNEL, later, AUDIO_LINK_SECONDARY));
+    OAN_CHECK(redundancy.stats().untracked == 2);
+
+    // An old stream coming back takes an idle entry too, and active streams keep theirs
+    OAN_CHECK(redundancy.accept(100, 0, later, AUDIO_LINK_PRIMARY));
+    OAN_CHECK(!redundancy.accept(100, 0, later, AUDIO_LINK_SECONDARY));
+    OAN_CHECK(redundancy.accept(SENDER_UID, CHANNEL, later + PERIOD_US, AUDIO_LINK_SECONDARY));
+    OAN_CHECK(!redundancy.accept(SENDER_UID, CHANNEL, later + PERIOD_US, AUDIO_LINK_PRIMARY));
+    OAN_CHECK(redundancy.stats().untracked == 2);
+}
+
+static void remove_links() {
+    char command[64];
+    for (auto& link : LINKS) {
+        snprintf(command, sizeof(command), "ip link del %s 2>/dev/null", link[0]);
+        (void)system(command);
+    }
+}
+
+static bool create_links() {
+    remove_links();
+
+    char command[128];
+    for (auto& link : LINKS) {
+        snprintf(command, sizeof(command), "ip link add %s type veth peer name %s 2>/dev/null", link[0], link[1]);
+        if (system(command) != 0) {
+            return false;
+        }
+
+        snprintf(command, sizeof(command), "ip link set %s up && ip link set %s up", link[0], link[1]);
+        if (system(command) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void send_frame(LowLatSocket& socket, uint16_t sender_uid, uint16_t dest_uid, uint64_t timestamp) {
+    LowLatPacket<AudioPacket> frame{};
+    socket.format_packet_header(reinterpret_cast<uint8_t*>(&frame), 0, sizeof(AudioPacket));
+    frame.llhdr.sender_uid = sender_uid;
+    frame.llhdr.dest_uid = dest_uid;
+    frame.payload.header.type = PacketType::AUDIO;
+    frame.payload.header.version = OAN_PROTOCOL_VERSION;
+    frame.payload.header.timestamp = timestamp;
+    frame.payload.packet_data.channel = CHANNEL;
+
+    OAN_CHECK(socket.send_data_raw(reinterpret_cast<char*>(&frame), sizeof(frame)) == (int)sizeof(frame));
+}
+
+// Small batches, the default socket buffers hold a few dozen frames
+static void drain(AudioRedundancy& redundancy, std::map<uint64_t, size_t>& delivered) {
+    alignas(std::max_align_t) uint8_t buffer[sizeof(LowLatPacket<AudioPacket>)];
+    auto idle_since = std::chrono::steady_clock::now();
+
+    // veth delivery goes through the backlog softirq, wait a little for the frames still in flight
+    while (std::chrono::steady_clock::now() - idle_since < std::chrono::milliseconds(5)) {
+        int recv_bytes = redundancy.receive(buffer, sizeof(buffer), true);
+        if (recv_bytes <= 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+
+        idle_since = std::chrono::steady_clock::now();
+        PacketView<AudioData> view{buffer, (size_t)recv_bytes};
+        OAN_CHECK(view.valid());
+        OAN_CHECK(view.llhdr().dest_uid == SELF_UID);
+        OAN_CHECK(view.llhdr().sender_uid == SENDER_UID);
+        delivered[view.packet().header.timestamp]++;
+    }
+}
+
+static bool wait_links_ready(LowLatSocket* senders, LowLatSocket* receivers) {
+    alignas(std::max_align_t) uint8_t buffer[sizeof(LowLatPacket<AudioPacket>)];
+
+    // A new veth drops frames until its qdisc is activated, which the kernel may defer for up to a second
+    for (size_t link = 0; link < 2; link++) {
+        bool ready = false;
+
+        for (size_t attempt = 0; attempt < 200 && !ready; attempt++) {
+            send_frame(senders[link], SENDER_UID, OTHER_UID, 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            while (receivers[link].receive_data_raw(reinterpret_cast<char*>(buffer), sizeof(buffer), true) > 0) {
+                ready = true;
+            }
+        }
+
+        if (!ready) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int check_links() {
+    if (geteuid() != 0 || !create_links()) {
+        remove_links();
+        return OAN_TEST_SKIP;
+    }
+
+    LowLatSocket senders[2] = {{SENDER_UID, nullptr}, {SENDER_UID, nullptr}};
+    LowLatSocket receivers[2] = {{SELF_UID, nullptr}, {SELF_UID, nullptr}};
+    for (size_t link = 0; link < 2; link++) {
+        OAN_CHECK(senders[link].init_socket(LINKS[link][0], ETH_PROTO_OANAUDIO));
+        OAN_CHECK(receivers[link].init_socket(LINKS[link][1], ETH_PROTO_OANAUDIO));
+    }
+    OAN_CHECK(wait_links_ready(senders, receivers));
+
+    AudioRedundancy redundancy{SELF_UID};
+    redundancy.set_links(&receivers[AUDIO_LINK_PRIMARY], &receivers[AUDIO_LINK_SECONDARY]);
+    std::map<uint64_t, size_t> delivered;
+
+    // More foreign streams than table entries, broadcast and unicast to another node
+    for (uint32_t i = 0; i < AUDIO_REDUNDANCY_MAX_STREAMS + 64; i++) {
+        for (auto& sender : senders) {
+            send_frame(sender, 1000 + i, i % 2 == 0 ? 0 : OTHER_UID, 1000);
+        }
+
+        if (i % 8 == 7) {
+            drain(redundancy, delivered);
+        }
+    }
+    drain(redundancy, delivered);
+    OAN_CHECK(delivered.empty());
+
+    // Each link loses its own frames, never the same ones
+    for (size_t i = 0; i < FRAMES; i++) {
+        uint64_t timestamp = 1000 + i * PERIOD_US;
+
+        if (i % 6 != 0) {
+            send_frame(senders[AUDIO_LINK_PRIMARY], SENDER_UID, SELF_UID, timestamp);
+        }
+        if (i % 6 != 3) {
+            send_frame(senders[AUDIO_LINK_SECONDARY], SENDER_UID, SELF_UID, timestamp);
+        }
+
+        if (i % 8 == 7) {
+            drain(redundancy, delivered);
+        }
+    }
+    drain(redundancy, delivered);
+
+    AudioRedundancyStats stats = redundancy.stats();
+    std::printf("redundancy_veth: %zu frames, received %lu + %lu, used %lu + %lu, %lu duplicates, %lu untracked\n",
+                FRAMES, stats.received[0], stats.received[1], stats.used[0], stats.used[1], stats.duplicates, stats.untracked);
+
+    remove_links();
+
+    OAN_CHECK(delivered.size() == FRAMES);
+    for (size_t i = 0; i < FRAMES; i++) {
+        auto it = delivered.find(1000 + i * PERIOD_US);
+        OAN_CHECK(it != delivered.end() && it->second == 1);
+    }
+    OAN_CHECK(stats.untracked == 0);
+    OAN_CHECK(stats.late == 0);
+
+    return 0;
+}
+
+int main() {
+    check_stream_table();
+
+    return check_links();
+}
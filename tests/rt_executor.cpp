@@ -0,0 +1,103 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Executor cycle accounting, driven with run_cycle from the test thread like a NO_THREADS host loop, default
+// scheduler and no memory locking. One cycle stalls two and a half periods: it must count as a single overrun, the
+// two periods it covered are skipped, and the histograms hold the expected samples. The period is long so that the
+// wakeup jitter of a loaded machine (a few ms) cannot cause other overruns. The histogram percentiles are checked on
+// known values.
+
+#include <vector>
+
+#include "common/RtExecutor.h"
+#include "netutils/rt.h"
+#include "test_util.h"
+
+static constexpr uint32_t FRAMES = 2400;
+static constexpr uint32_t RATE_HZ = 48000;
+static constexpr uint64_t PERIOD_NS = (uint64_t)FRAMES * 1'000'000'000 / RATE_HZ;   // 50 ms
+static constexpr uint64_t STALLED_CYCLE = 3;
+static constexpr uint64_t CYCLES = 8;
+
+static void check_percentiles() {
+    RtHistogram histogram;
+    OAN_CHECK(histogram.snapshot().percentile_ns(0.5) == 0);
+
+    // Buckets 0, 1, 1, 2 and the overflow one
+    for (uint64_t value : {1000, 2500, 3900, 4100, 10'000'000}) {
+        histogram.record(value);
+    }
+
+    RtHistogramSnapshot snap = histogram.snapshot();
+    OAN_CHECK(snap.count == 5 && snap.min_ns == 1000 && snap.max_ns == 10'000'000);
+    OAN_CHECK(snap.buckets[0] == 1 && snap.buckets[1] == 2 && snap.buckets[2] == 1);
+    OAN_CHECK(snap.buckets[RT_HISTOGRAM_BUCKETS - 1] == 1);
+
+    OAN_CHECK(snap.percentile_ns(0) == RT_HISTOGRAM_BUCKET_NS);
+    OAN_CHECK(snap.percentile_ns(0.2) == RT_HISTOGRAM_BUCKET_NS);
+    OAN_CHECK(snap.percentile_ns(0.5) == 2 * RT_HISTOGRAM_BUCKET_NS);
+    OAN_CHECK(snap.percentile_ns(0.8) == 3 * RT_HISTOGRAM_BUCKET_NS);
+    OAN_CHECK(snap.percentile_ns(1) == snap.max_ns);
+
+    // The bound never exceeds the largest value
+    histogram.reset();
+    histogram.record(2100);
+    OAN_CHECK(histogram.snapshot().percentile_ns(1) == 2100);
+}
+
+int main() {
+    check_percentiles();
+
+    RtExecutorConfig config = RtExecutor::make_config(SamplingRate::SAMPLING_48K, FRAMES);
+    config.policy = RT_POLICY_NONE;
+    config.lock_memory = false;
+    config.spin_ns = 100'000;
+
+    std::vector<uint64_t> indices;
+    RtExecutor executor{config, [&indices](uint64_t cycle, uint64_t start) {
+        indices.push_back(cycle);
+
+        if (cycle == STALLED_CYCLE) {
+            while (oals::rt::monotonic_ns() < start + PERIOD_NS * 5 / 2) {
+            }
+        }
+    }};
+
+    for (uint64_t i = 0; i < CYCLES; i++) {
+        executor.run_cycle();
+    }
+
+    // The stall ends in the third period after its own, the two it covered are not run
+    OAN_CHECK(indices == (std::vector<uint64_t>{0, 1, 2, 3, 6, 7, 8, 9}));
+
+    RtExecutorStats stats = executor.stats();
+    OAN_CHECK(stats.cycles == CYCLES);
+    OAN_CHECK(stats.overruns == 1);
+    OAN_CHECK(stats.missed_periods == 2);
+    OAN_CHECK(stats.policy == RT_POLICY_NONE && !stats.memory_locked);
+
+    OAN_CHECK(stats.wakeup_latency.count == CYCLES);
+    OAN_CHECK(stats.execution.count == CYCLES);
+    OAN_CHECK(stats.execution.max_ns >= 2 * PERIOD_NS);
+
+    // The stall is far beyond the histogram range: overflow bucket, reported as the largest value. Short cycles may
+    // land there too when the machine preempts the test
+    OAN_CHECK(stats.execution.buckets[RT_HISTOGRAM_BUCKETS - 1] >= 1);
+    OAN_CHECK(stats.execution.percentile_ns(1) == stats.execution.max_ns);
+    uint64_t median = stats.execution.percentile_ns(0.5);
+    OAN_CHECK(median % RT_HISTOGRAM_BUCKET_NS == 0 || median == stats.execution.max_ns);
+
+    // Measured from the start of the next period, the one right after the stalled cycle
+    OAN_CHECK(stats.overrun.count == 1);
+    OAN_CHECK(stats.overrun.min_ns >= PERIOD_NS * 3 / 2 && stats.overrun.max_ns < 2 * PERIOD_NS);
+    OAN_CHECK(stats.overrun.buckets[RT_HISTOGRAM_BUCKETS - 1] == 1);
+
+    executor.reset_stats();
+    stats = executor.stats();
+    OAN_CHECK(stats.cycles == 0 && stats.overruns == 0 && stats.missed_periods == 0);
+    OAN_CHECK(stats.execution.count == 0 && stats.overrun.count == 0);
+
+    return 0;
+}
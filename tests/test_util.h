@@ -0,0 +1,28 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+#ifndef OAN_TEST_UTIL_H
+#define OAN_TEST_UTIL_H
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Exit code telling ctest that the test could not run here (SKIP_RETURN_CODE)
+ */
+#define OAN_TEST_SKIP 77
+
+/**
+ * Fail the test with the checked expression and its location
+ */
+#define OAN_CHECK(expr)                                                                     \
+    do {                                                                                    \
+        if (!(expr)) {                                                                      \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);   \
+            std::exit(1);                                                                   \
+        }                                                                                   \
+    } while (0)
+
+#endif //OAN_TEST_UTIL_H
@@ -0,0 +1,170 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Timer wheel driven with advance and synthetic times, always ahead of the real clock so that delays count from the
+// wheel position. The wheel is only advanced to what next_deadline reports: one shot timers on every level and beyond
+// the horizon must then fire exactly on their deadline, which also checks that next_deadline is never later than the
+// earliest live deadline. Periodic catch-up and cancellation from callbacks are checked too.
+
+#include <random>
+#include <vector>
+
+#include "common/TimerWheel.h"
+#include "netutils/tstamp.h"
+#include "test_util.h"
+
+static constexpr uint64_t TICK_US = 1000;
+static constexpr uint64_t HORIZON_TICKS = 1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS);
+
+// Far enough ahead of the real clock for the whole run
+static uint64_t start_time(TimerWheel& wheel) {
+    uint64_t start = (oals::tstamp::now_us() / TICK_US + 10'000) * TICK_US;
+    wheel.advance(start);
+    return start;
+}
+
+struct OneShot {
+    TimerId id;
+    uint64_t deadline_us;
+    uint64_t fired_us;
+    bool cancelled;
+};
+
+static void run_to_completion(TimerWheel& wheel, uint64_t& now, const std::vector<OneShot>& timers) {
+    while (auto next = wheel.next_deadline()) {
+        uint64_t earliest = UINT64_MAX;
+        for (auto& timer : timers) {
+            if (!timer.cancelled && timer.fired_us == 0) {
+                earliest = std::min(earliest, timer.deadline_us);
+            }
+        }
+
+        OAN_CHECK(next.value() > now);
+        OAN_CHECK(next.value() <= earliest);
+        now = next.value();
+        wheel.advance(now);
+    }
+
+    for (auto& timer : timers) {
+        OAN_CHECK(timer.fired_us == (timer.cancelled ? 0 : timer.deadline_us));
+    }
+}
+
+static void check_one_shots() {
+    TimerWheel wheel{TICK_US};
+    uint64_t now = start_time(wheel);
+    OAN_CHECK(!wheel.next_deadline().has_value());
+
+    // Both edges of every level, then beyond the horizon
+    std::vector<uint64_t> delays = {1, 2, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+                                    HORIZON_TICKS - 1, HORIZON_TICKS, HORIZON_TICKS + 1, HORIZON_TICKS + 5000};
+
+    // Spread over the levels
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < 400; i++) {
+        delays.push_back(1 + rng() % (1ULL << (TIMER_WHEEL_SLOT_BITS * (1 + i % TIMER_WHEEL_LEVELS))));
+    }
+
+    std::vector<OneShot> timers;
+    timers.reserve(delays.size());
+    for (uint64_t delay : delays) {
+        size_t index = timers.size();
+        TimerId id = wheel.schedule(delay * TICK_US, [&timers, &now, index]() {
+            OAN_CHECK(timers[index].fired_us == 0);
+            timers[index].fired_us = now;
+        });
+        timers.push_back(OneShot{id, now + delay * TICK_US, 0, false});
+    }
+
+    // Every fifth timer never fires
+    for (size_t i = 0; i < timers.size(); i += 5) {
+        OAN_CHECK(wheel.cancel(timers[i].id));
+        OAN_CHECK(!wheel.cancel(timers[i].id));
+        timers[i].cancelled = true;
+    }
+
+    run_to_completion(wheel, now, timers);
+}
+
+static void check_periodic() {
+    TimerWheel wheel{TICK_US};
+    uint64_t start = start_time(wheel);
+    std::vector<uint64_t> calls;
+    uint64_t now = start;
+
+    wheel.schedule(10 * TICK_US, [&calls, &now]() {
+        calls.push_back(now);
+    }, 10 * TICK_US);
+
+    now = start + 10 * TICK_US;
+    wheel.advance(now);
+    OAN_CHECK(calls.size() == 1);
+    OAN_CHECK(wheel.next_deadline() == start + 20 * TICK_US);
+
+    // Four periods missed: a single call, the next one a tick after the catch-up
+    now = start + 55 * TICK_US;
+    wheel.advance(now);
+    OAN_CHECK(calls.size() == 2);
+    OAN_CHECK(wheel.next_deadline() == start + 56 * TICK_US);
+
+    now = start + 56 * TICK_US;
+    wheel.advance(now);
+    now = start + 66 * TICK_US;
+    wheel.advance(now);
+    OAN_CHECK(calls == (std::vector<uint64_t>{start + 10 * TICK_US, start + 55 * TICK_US, start + 56 * TICK_US, start + 66 * TICK_US}));
+
+    // Between deadlines nothing runs
+    now = start + 75 * TICK_US;
+    wheel.advance(now);
+    OAN_CHECK(calls.size() == 4);
+}
+
+static void check_cancel_from_callback() {
+    TimerWheel wheel{TICK_US};
+    uint64_t start = start_time(wheel);
+    int self_periodic = 0, self_one_shot = 0, victim = 0, later = 0;
+    TimerId periodic_id = 0, one_shot_id = 0, victim_id = 0;
+    bool periodic_cancelled = false, one_shot_cancelled = true;
+
+    // A periodic timer cancelling itself is not rescheduled
+    periodic_id = wheel.schedule(5 * TICK_US, [&]() {
+        self_periodic++;
+        periodic_cancelled = wheel.cancel(periodic_id);
+    }, 5 * TICK_US);
+
+    // A one shot timer is gone once its callback runs
+    one_shot_id = wheel.schedule(5 * TICK_US, [&]() {
+        self_one_shot++;
+        one_shot_cancelled = wheel.cancel(one_shot_id);
+    });
+
+    // A timer expiring in the same advance is cancelled before it runs, and callbacks may schedule
+    wheel.schedule(5 * TICK_US, [&]() {
+        OAN_CHECK(wheel.cancel(victim_id));
+        wheel.schedule(3 * TICK_US, [&]() {
+            later++;
+        });
+    });
+    victim_id = wheel.schedule(5 * TICK_US, [&]() {
+        victim++;
+    });
+
+    wheel.advance(start + 5 * TICK_US);
+    OAN_CHECK(self_periodic == 1 && periodic_cancelled);
+    OAN_CHECK(self_one_shot == 1 && !one_shot_cancelled);
+    OAN_CHECK(victim == 0);
+    OAN_CHECK(wheel.next_deadline() == start + 8 * TICK_US);
+
+    wheel.advance(start + 100 * TICK_US);
+    OAN_CHECK(self_periodic == 1 && victim == 0 && later == 1);
+    OAN_CHECK(!wheel.next_deadline().has_value());
+}
+
+int main() {
+    check_one_shots();
+    check_periodic();
+    check_cancel_from_callback();
+    return 0;
+}
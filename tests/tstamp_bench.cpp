@@ -0,0 +1,68 @@
+// This file is part of the Open Audio Live System project, a live audio environment
+// Copyright (c) 2026 - Mathis DELGADO
+//
+// This project is distributed under the Creative Commons CC-BY-NC-SA licence. https://creativecommons.org/licenses/by-nc-sa/4.0
+
+// Per call cost of the timestamp sources: std::chrono::high_resolution_clock, oals::tstamp::now_ns on
+// CLOCK_MONOTONIC_RAW, then on the calibrated TSC when the CPU has an invariant one. Every source must be monotonic,
+// and the TSC path must stay on CLOCK_MONOTONIC_RAW.
+
+#include <chrono>
+#include <ctime>
+
+#include "netutils/tstamp.h"
+#include "test_util.h"
+
+static constexpr int CALLS = 2'000'000;
+
+template<class F>
+static double bench(const char* name, F&& now) {
+    uint64_t previous = now();
+    uint64_t start = oals::tstamp::now_ns();
+
+    for (int i = 0; i < CALLS; i++) {
+        uint64_t value = now();
+        OAN_CHECK(value >= previous);
+        previous = value;
+    }
+
+    double per_call = (double)(oals::tstamp::now_ns() - start) / CALLS;
+    std::printf("tstamp: %-28s %.1f ns/call\n", name, per_call);
+    return per_call;
+}
+
+static uint64_t monotonic_raw_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+int main() {
+    bench("high_resolution_clock", []() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    });
+
+    OAN_CHECK(!oals::tstamp::tsc_enabled());
+    bench("now_ns (CLOCK_MONOTONIC_RAW)", []() {
+        return oals::tstamp::now_ns();
+    });
+
+    if (!oals::tstamp::enable_tsc()) {
+        std::printf("tstamp: no invariant TSC, fast path not measured\n");
+        return 0;
+    }
+
+    bench("now_ns (TSC)", []() {
+        return oals::tstamp::now_ns();
+    });
+
+    // Calibrated over 20 ms, the drift over the run stays far below a millisecond
+    uint64_t tsc = oals::tstamp::now_ns();
+    uint64_t raw = monotonic_raw_ns();
+    uint64_t drift = tsc > raw ? tsc - raw : raw - tsc;
+    std::printf("tstamp: TSC path %lu ns from CLOCK_MONOTONIC_RAW\n", drift);
+    OAN_CHECK(drift < 1'000'000);
+
+    return 0;
+}
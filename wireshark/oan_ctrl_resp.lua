@@ -11,12 +11,16 @@ oan_ctrl_resp = Proto("osstctrlresp", "OAN Control Response")
 
 oan_resp_code    = ProtoField.uint8("oan.ctrl.resp.code", "Response Code", base.HEX)
 oan_resp_channel = ProtoField.uint8("oan.ctrl.resp.channel", "Channel", base.DEC)
+oan_resp_pid     = ProtoField.uint16("oan.ctrl.resp.pid", "Pipe ID", base.DEC)
 oan_resp_err_msg = ProtoField.string("oan.ctrl.resp.err_msg", "Error Message")
+oan_resp_seq     = ProtoField.uint8("oan.ctrl.resp.seq", "Seq", base.DEC)
 
 oan_ctrl_resp.fields = {
 	oan_resp_code,
 	oan_resp_channel,
-	oan_resp_err_msg
+	oan_resp_pid,
+	oan_resp_err_msg,
+	oan_resp_seq
 }
 
 function oan_ctrl_resp.dissector(buffer, pinfo, tree)
@@ -35,5 +39,10 @@ function oan_ctrl_resp.dissector(buffer, pinfo, tree)
 
 	subtree:add_le(oan_resp_code,    buffer(0, 1))
 	subtree:add_le(oan_resp_channel, buffer(1, 1))
-	subtree:add_le(oan_resp_err_msg, buffer(2, 64))
+	subtree:add_le(oan_resp_pid,     buffer(2, 2))
+	subtree:add_le(oan_resp_err_msg, buffer(4, 64))
+
+	if length > 68 then
+		subtree:add_le(oan_resp_seq, buffer(68, 1))
+	end
 end
@@ -57,6 +57,10 @@ function get_oan_packet_type(packet_type_hex)
 	elseif packet_type_hex == 0x04 then pname = "Control Query"
 	elseif packet_type_hex == 0x05 then pname = "Audio"
 	elseif packet_type_hex == 0x06 then pname = "Clock Sync"
+	elseif packet_type_hex == 0x07 then pname = "Control Batch"
+	elseif packet_type_hex == 0x08 then pname = "Heartbeat"
+	elseif packet_type_hex == 0x09 then pname = "Mapping Delta"
+	elseif packet_type_hex == 0x0A then pname = "Control State"
 	end
 
 	return pname
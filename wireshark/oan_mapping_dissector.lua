@@ -7,6 +7,7 @@ oan_map_device_type = ProtoField.uint16("oan.map.dtype", "deviceType", base.HEX)
 oan_map_sampling_rate = ProtoField.uint32("oan.map.srate", "sampleRate", base.HEX)
 oan_map_node_topo = ProtoField.none("oan.map.node_topo", "nodeTopo")
 oan_map_cktype = ProtoField.uint32("oan.map.cktype", "clockType", base.HEX)
+oan_map_generation = ProtoField.uint32("oan.map.gen", "generation", base.DEC)
 
 oan_mapping.fields = {
 	oan_map_devname,
@@ -15,7 +16,8 @@ oan_mapping.fields = {
 	oan_map_device_type,
 	oan_map_sampling_rate,
 	oan_map_node_topo,
-	oan_map_cktype
+	oan_map_cktype,
+	oan_map_generation
 }
 
 function oan_mapping.dissector(buffer, pinfo, tree)
@@ -37,6 +39,7 @@ function oan_mapping.dissector(buffer, pinfo, tree)
 	subtree:add_le(oan_map_sampling_rate, buffer(44, 4))
 	subtree:add_le(oan_map_node_topo, buffer(48, 20))
 	subtree:add_le(oan_map_cktype, buffer(48+20, 4)):append_text(" (" .. ck_type .. ") ")
+	subtree:add_le(oan_map_generation, buffer(72, 4))
 end
 
 function get_oan_clock_type_name(clock_type_hex)